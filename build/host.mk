@@ -0,0 +1,101 @@
+.PHONY: all bench test size clean
+
+### Target Platform ####################
+# Linux host build: the application runs against the ESP8266 simulator
+# (pseudo terminal) instead of the UART of the ZX Spectrum Next.
+#
+#   make -f host.mk          build espcmd, espsim and espbench
+#   make -f host.mk bench    run the benchmark suite
+#   make -f host.mk test     run the unit tests of the pure C modules
+#   make -f host.mk size     code/bss size of the application modules
+
+### Project Name #######################
+APPNAME := espcmd
+
+### Build Type #########################
+BUILD ?= release
+
+# TRACE=1: in-memory event trace (debug and release), dumped at the end
+TRACE ?= 0
+
+### Source Directories #################
+SRC_DIR  := ../src
+INC_DIR  := ../inc
+HOST_DIR := ../host
+BLD_DIR  := ./host
+
+### Source Files #######################
+# hardware modules are replaced by their counterparts in host/src
+HW_SRCS   := $(SRC_DIR)/espuart.c
+SRCS      := $(filter-out $(HW_SRCS),$(wildcard $(SRC_DIR)/*.c)) $(wildcard $(HOST_DIR)/src/*.c)
+SIM_SRCS  := $(HOST_DIR)/sim/espsim.c
+BNCH_SRCS := $(HOST_DIR)/bench/espbench.c
+TEST_SRCS := $(HOST_DIR)/test/esptest.c $(filter-out %/main.c,$(SRCS))
+APP_SRCS  := $(filter-out $(HW_SRCS),$(wildcard $(SRC_DIR)/*.c))
+
+### INCLUDE Directories ################
+# host replacements of z88dk/libzxn/libesp come first
+INCS := -I$(HOST_DIR)/inc
+INCS += -I$(INC_DIR)
+
+### Compiler Flags #####################
+CFLAGS := -std=gnu11 -Wall -Wextra
+CFLAGS += -include $(HOST_DIR)/inc/hostcompat.h
+CFLAGS += $(INCS)
+
+ifeq ($(BUILD), debug)
+# create debug code
+CFLAGS += -O0 -g -D__DEBUG__
+else
+CFLAGS += -O2
+endif
+
+ifeq ($(TRACE), 1)
+CFLAGS += -D__TRACE__
+endif
+
+### Compiler Command ###################
+CC ?= cc
+SIZE ?= size
+
+### Build Target #######################
+all: $(BLD_DIR)/$(APPNAME) $(BLD_DIR)/espsim $(BLD_DIR)/espbench
+
+$(BLD_DIR)/$(APPNAME): $(SRCS) $(wildcard $(INC_DIR)/*.h) $(wildcard $(HOST_DIR)/inc/*.h)
+	@mkdir -p $(BLD_DIR)
+	$(CC) $(CFLAGS) $(SRCS) -o $@ -pthread
+
+$(BLD_DIR)/espsim: $(SIM_SRCS)
+	@mkdir -p $(BLD_DIR)
+	$(CC) -std=gnu11 -Wall -Wextra -O2 $(SIM_SRCS) -o $@
+
+$(BLD_DIR)/espbench: $(BNCH_SRCS)
+	@mkdir -p $(BLD_DIR)
+	$(CC) -std=gnu11 -Wall -Wextra -O2 $(BNCH_SRCS) -o $@
+
+### Benchmark ##########################
+bench: all
+	$(BLD_DIR)/espbench
+
+### Unit Tests #######################
+$(BLD_DIR)/esptest: $(TEST_SRCS) $(wildcard $(INC_DIR)/*.h) $(wildcard $(HOST_DIR)/inc/*.h)
+	@mkdir -p $(BLD_DIR)
+	$(CC) $(CFLAGS) $(TEST_SRCS) -o $@ -pthread
+
+test: $(BLD_DIR)/esptest
+	$(BLD_DIR)/esptest
+
+### Size Report ######################
+# Relative budget of the application modules (without host shims), compiled
+# for size; the absolute numbers of the Z80 build are reported by "size" of
+# the makefile
+size:
+	@mkdir -p $(BLD_DIR)/obj
+	@for f in $(APP_SRCS); do \
+	  $(CC) $(CFLAGS) -Os -c $$f -o $(BLD_DIR)/obj/$$(basename $$f .c).o || exit 1; \
+	done
+	$(SIZE) -t $(BLD_DIR)/obj/*.o
+
+### Cleanup Build Files ################
+clean:
+	@$(RM) -r $(BLD_DIR)
@@ -0,0 +1,402 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espbench.c                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: latency/throughput benchmark of espcmd against the ESP8266       |
+| simulator (commands/sec, time-to-OK percentiles, bytes/sec)                  |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <libgen.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Maximum number of arguments of the simulator in a scenario
+*/
+#define uiBENCH_MAX_SIM_ARGS (12)
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+One benchmark scenario: simulator configuration and AT command
+*/
+typedef struct _scenario
+{
+  const char* acName;
+  const char* acCmd;
+  unsigned    uiCount;
+  const char* acSimArgs[uiBENCH_MAX_SIM_ARGS];
+} scenario_t;
+
+/*!
+Measurement of one request (see "hostuart.c")
+*/
+typedef struct _sample
+{
+  uint64_t uiTx;
+  uint64_t uiFirst;
+  uint64_t uiFinal;
+  unsigned long uiBytes;
+  int      iOk;
+} sample_t;
+
+/*============================================================================*/
+/*                               Konstanten                                   */
+/*============================================================================*/
+/*!
+Default scenarios
+*/
+static const scenario_t g_atScenarios[] =
+{
+  { "at",          "AT",       500, { "-E" } },
+  { "at-echo",     "AT",       500, { 0 } },
+  { "at-latency",  "AT",       200, { "-E", "-l", "2000" } },
+  { "gmr-115k",    "AT+GMR",    50, { "-E", "-b", "115200" } },
+  { "cwlap-115k",  "AT+CWLAP",  20, { "-E", "-b", "115200", "-n", "20", "-w", "80" } },
+  { "cwlap-2m",    "AT+CWLAP",  50, { "-E", "-b", "2000000", "-n", "40", "-w", "120" } },
+  { "cwlap-long",  "AT+CWLAP", 100, { "-E", "-n", "20", "-w", "300" } },
+};
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Directory of the host binaries ("espcmd", "espsim")
+*/
+static char g_acBinDir[PATH_MAX - 0x10];
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* startSimulator()                                                           */
+/*----------------------------------------------------------------------------*/
+static pid_t startSimulator(const scenario_t* pScenario, char* acTty, size_t uiSize)
+{
+  char acPath[PATH_MAX];
+  const char* acArgs[uiBENCH_MAX_SIM_ARGS + 2];
+  int aiPipe[2];
+  pid_t iPid;
+  FILE* pOut;
+  size_t n = 0;
+
+  snprintf(acPath, sizeof(acPath), "%s/espsim", g_acBinDir);
+
+  acArgs[n++] = acPath;
+  for (size_t i = 0; (i < uiBENCH_MAX_SIM_ARGS) && pScenario->acSimArgs[i]; ++i)
+  {
+    acArgs[n++] = pScenario->acSimArgs[i];
+  }
+  acArgs[n] = 0;
+
+  if (0 != pipe(aiPipe))
+  {
+    return -1;
+  }
+
+  if (0 == (iPid = fork()))
+  {
+    dup2(aiPipe[1], STDOUT_FILENO);
+    close(aiPipe[0]);
+    close(aiPipe[1]);
+    execv(acPath, (char* const*) acArgs);
+    perror("espbench: espsim");
+    _exit(127);
+  }
+
+  close(aiPipe[1]);
+
+  if ((0 > iPid) || (0 == (pOut = fdopen(aiPipe[0], "r"))))
+  {
+    close(aiPipe[0]);
+    return -1;
+  }
+
+  if (!fgets(acTty, (int) uiSize, pOut))
+  {
+    fclose(pOut);
+    kill(iPid, SIGTERM);
+    waitpid(iPid, 0, 0);
+    return -1;
+  }
+
+  fclose(pOut);
+  acTty[strcspn(acTty, "\r\n")] = '\0';
+
+  return iPid;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* runEspcmdEx()                                                              */
+/*----------------------------------------------------------------------------*/
+static int runEspcmdEx(const char* acTty, const char* acArg1, const char* acArg2, const char* acStats)
+{
+  char acPath[PATH_MAX];
+  pid_t iPid;
+  int iStatus = 0;
+
+  snprintf(acPath, sizeof(acPath), "%s/espcmd", g_acBinDir);
+
+  if (0 == (iPid = fork()))
+  {
+    setenv("ESPCMD_TTY", acTty, 1);
+    if (acStats)
+    {
+      setenv("ESPCMD_STATS", acStats, 1);
+    }
+    execl(acPath, acPath, "-q", acArg1, acArg2, (char*) 0);
+    perror("espbench: espcmd");
+    _exit(127);
+  }
+
+  if ((0 > iPid) || (0 > waitpid(iPid, &iStatus, 0)))
+  {
+    return -1;
+  }
+
+  return WIFEXITED(iStatus) ? WEXITSTATUS(iStatus) : -1;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* runEspcmd()                                                                */
+/*----------------------------------------------------------------------------*/
+static int runEspcmd(const char* acTty, const char* acScript, const char* acStats)
+{
+  return runEspcmdEx(acTty, "-f", acScript, acStats);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* compareU64()                                                               */
+/*----------------------------------------------------------------------------*/
+static int compareU64(const void* pA, const void* pB)
+{
+  uint64_t a = *(const uint64_t*) pA;
+  uint64_t b = *(const uint64_t*) pB;
+  return (a > b) - (a < b);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* percentile()                                                               */
+/*----------------------------------------------------------------------------*/
+static double percentile(const uint64_t* puiSorted, size_t uiCount, unsigned uiPercent)
+{
+  size_t uiIndex = ((uiCount - 1) * uiPercent + 50) / 100;
+  return (double) puiSorted[uiIndex] / 1000.0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* runScenario()                                                              */
+/*----------------------------------------------------------------------------*/
+static int runScenario(const scenario_t* pScenario, unsigned uiCount)
+{
+  char acTty[PATH_MAX];
+  char acScript[] = "/tmp/espbench-XXXXXX";
+  char acStats[sizeof(acScript) + 8];
+  sample_t* pSamples;
+  uint64_t* puiToOk;
+  uint64_t* puiFirst;
+  size_t uiSamples = 0;
+  size_t uiOk = 0;
+  uint64_t uiBytes = 0;
+  pid_t iSim;
+  FILE* pFile;
+  int iFd;
+  int iExit;
+
+  if (0 > (iFd = mkstemp(acScript)) || (0 == (pFile = fdopen(iFd, "w"))))
+  {
+    perror("espbench: script");
+    return -1;
+  }
+
+  for (unsigned i = 0; i < uiCount; ++i)
+  {
+    fprintf(pFile, "%s\n", pScenario->acCmd);
+  }
+  fclose(pFile);
+
+  snprintf(acStats, sizeof(acStats), "%s.stats", acScript);
+
+  if (0 > (iSim = startSimulator(pScenario, acTty, sizeof(acTty))))
+  {
+    fprintf(stderr, "espbench: cannot start simulator\n");
+    unlink(acScript);
+    return -1;
+  }
+
+  /* Warm-up: the measured run starts with a valid cached link state */
+  runEspcmdEx(acTty, "AT", 0, 0);
+  iExit = runEspcmd(acTty, acScript, acStats);
+
+  kill(iSim, SIGTERM);
+  waitpid(iSim, 0, 0);
+  unlink(acScript);
+
+  pSamples = calloc(uiCount + 1, sizeof(sample_t));
+  puiToOk  = calloc(uiCount + 1, sizeof(uint64_t));
+  puiFirst = calloc(uiCount + 1, sizeof(uint64_t));
+
+  if (pSamples && puiToOk && puiFirst && (0 != (pFile = fopen(acStats, "r"))))
+  {
+    sample_t* p = &pSamples[0];
+    unsigned long long uiTx, uiFirst, uiFinal;
+
+    while ((uiSamples <= uiCount) &&
+           (5 == fscanf(pFile, "%llu %llu %llu %lu %d", &uiTx, &uiFirst, &uiFinal, &p->uiBytes, &p->iOk)))
+    {
+      p->uiTx    = uiTx;
+      p->uiFirst = uiFirst;
+      p->uiFinal = uiFinal;
+
+      puiToOk[uiSamples]  = p->uiFinal - p->uiTx;
+      puiFirst[uiSamples] = p->uiFirst - p->uiTx;
+      uiBytes += p->uiBytes;
+      uiOk    += p->iOk ? 1 : 0;
+
+      p = &pSamples[++uiSamples];
+    }
+
+    fclose(pFile);
+  }
+
+  unlink(acStats);
+
+  if (0 == uiSamples)
+  {
+    printf("%-12s  no samples (exit %d)\n", pScenario->acName, iExit);
+  }
+  else
+  {
+    double fWall = (double) (pSamples[uiSamples - 1].uiFinal - pSamples[0].uiTx) / 1e6;
+
+    qsort(puiToOk, uiSamples, sizeof(uint64_t), compareU64);
+    qsort(puiFirst, uiSamples, sizeof(uint64_t), compareU64);
+
+    printf("%-12s %5zu %5zu %9.1f %8.3f %8.3f %8.3f %8.3f %8.3f %10.0f\n",
+           pScenario->acName,
+           uiSamples,
+           uiOk,
+           (double) uiSamples / fWall,
+           percentile(puiFirst, uiSamples, 50),
+           percentile(puiToOk, uiSamples, 50),
+           percentile(puiToOk, uiSamples, 90),
+           percentile(puiToOk, uiSamples, 99),
+           (double) puiToOk[uiSamples - 1] / 1000.0,
+           (double) uiBytes / fWall);
+  }
+
+  free(pSamples);
+  free(puiToOk);
+  free(puiFirst);
+
+  return (uiSamples == uiCount) && (uiOk == uiCount) ? 0 : 1;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* main()                                                                     */
+/*----------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+  char acSelf[PATH_MAX];
+  const char* acFilter = 0;
+  unsigned uiCount = 0;
+  int iReturn = 0;
+  int iOpt;
+
+  while (-1 != (iOpt = getopt(argc, argv, "n:s:h")))
+  {
+    switch (iOpt)
+    {
+      case 'n':
+        uiCount = (unsigned) strtoul(optarg, 0, 0);
+        break;
+
+      case 's':
+        acFilter = optarg;
+        break;
+
+      default:
+        fprintf(stderr, "usage: espbench [-n count][-s scenario]\n");
+        return 1;
+    }
+  }
+
+  snprintf(acSelf, sizeof(acSelf), "%s", argv[0]);
+  snprintf(g_acBinDir, sizeof(g_acBinDir), "%.*s", (int) sizeof(g_acBinDir) - 1, dirname(acSelf));
+
+  printf("%-12s %5s %5s %9s %8s %8s %8s %8s %8s %10s\n",
+         "scenario", "cmds", "ok", "cmds/s", "1st[ms]", "p50[ms]", "p90[ms]", "p99[ms]", "max[ms]", "bytes/s");
+
+  for (size_t i = 0; i < sizeof(g_atScenarios) / sizeof(g_atScenarios[0]); ++i)
+  {
+    const scenario_t* pScenario = &g_atScenarios[i];
+
+    if (acFilter && (0 != strcmp(acFilter, pScenario->acName)))
+    {
+      continue;
+    }
+
+    if (0 != runScenario(pScenario, uiCount ? uiCount : pScenario->uiCount))
+    {
+      iReturn = 1;
+    }
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
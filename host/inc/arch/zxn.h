@@ -0,0 +1,50 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: zxn.h                                                              |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of <arch/zxn.h> (subset used by the application)     |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__HOST_ARCH_ZXN_H__)
+  #define __HOST_ARCH_ZXN_H__
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+CPU speeds of the Z80N
+*/
+#define RTM_3MHZ  (0x00)
+#define RTM_7MHZ  (0x01)
+#define RTM_14MHZ (0x02)
+#define RTM_28MHZ (0x03)
+
+#endif /* __HOST_ARCH_ZXN_H__ */
@@ -0,0 +1,114 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: esxdos.h                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of <arch/zxn/esxdos.h> that maps the esxDOS file     |
+| API to POSIX files                                                           |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__HOST_ARCH_ZXN_ESXDOS_H__)
+  #define __HOST_ARCH_ZXN_ESXDOS_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Open modes of "esx_f_open"
+*/
+#define ESX_MODE_READ               (0x01)
+#define ESX_MODE_WRITE              (0x02)
+#define ESX_MODE_OPEN_EXIST         (0x00)
+#define ESX_MODE_OPEN_CREAT         (0x08)
+#define ESX_MODE_OPEN_CREAT_NOEXIST (0x04)
+#define ESX_MODE_OPEN_CREAT_TRUNC   (0x0C)
+
+/*!
+Seek modes of "esx_f_seek"
+*/
+#define ESX_SEEK_SET (0x00)
+#define ESX_SEEK_FWD (0x01)
+#define ESX_SEEK_BWD (0x02)
+#define ESX_SEEK_END (0x03)
+
+/*!
+Version information of "esx_m_dosversion"
+*/
+#define ESX_BANKTYPE_RAM (0x00)
+
+#define ESX_DOSVERSION_NEXTOS_48K (0x0000)
+#define ESX_DOSVERSION_NEXTOS_MAJOR(x) (((x) >> 8) & 0xFF)
+#define ESX_DOSVERSION_NEXTOS_MINOR(x) ((x) & 0xFF)
+
+/*============================================================================*/
+/*                               Strukturen                                   */
+/*============================================================================*/
+/*!
+Time stamp of a file (MS-DOS format)
+*/
+struct dos_tm
+{
+  uint16_t time;
+  uint16_t date;
+};
+
+/*!
+Information of "esx_f_fstat"
+*/
+struct esx_stat
+{
+  uint8_t       drive;
+  uint8_t       device;
+  uint8_t       attr;
+  struct dos_tm time;
+  uint32_t      size;
+};
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+uint8_t  esx_f_open(const char* pcName, uint8_t uiMode);
+size_t   esx_f_read(uint8_t hFile, void* pDst, size_t uiSize);
+size_t   esx_f_write(uint8_t hFile, const void* pSrc, size_t uiSize);
+int      esx_f_seek(uint8_t hFile, uint32_t uiOffset, uint8_t uiWhence);
+int      esx_f_close(uint8_t hFile);
+uint8_t  esx_f_fstat(uint8_t hFile, struct esx_stat* pStat);
+int      esx_f_unlink(const char* pcName);
+uint16_t esx_m_dosversion(void);
+uint8_t  esx_ide_bank_alloc(uint8_t uiBankType);
+uint8_t  esx_ide_bank_free(uint8_t uiBankType, uint8_t uiPage);
+
+#endif /* __HOST_ARCH_ZXN_ESXDOS_H__ */
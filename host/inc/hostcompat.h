@@ -0,0 +1,68 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostcompat.h                                                       |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: compatibility definitions for z88dk specific library functions   |
+| (force-included into every translation unit of the host build)              |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__HOSTCOMPAT_H__)
+  #define __HOSTCOMPAT_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <strings.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+z88dk: case insensitive string compare
+*/
+#define stricmp strcasecmp
+
+/*!
+z88dk: case insensitive string compare (limited length)
+*/
+#define strnicmp strncasecmp
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+z88dk: convert string to upper case (in place)
+@param pcStr String to convert
+@return Pointer to the string
+*/
+char* strupr(char* pcStr);
+
+#endif /* __HOSTCOMPAT_H__ */
@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostuart.h                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: byte stream to the ESP8266 simulator (pty) including the         |
+| measurement of round trip times for the benchmark                            |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__HOSTUART_H__)
+  #define __HOSTUART_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Environment variable with the name of the pty of the simulator
+*/
+#define acHOSTUART_ENV_TTY "ESPCMD_TTY"
+
+/*!
+Environment variable with the name of the statistics file (optional)
+*/
+#define acHOSTUART_ENV_STATS "ESPCMD_STATS"
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Open the pty given by the environment variable "ESPCMD_TTY"
+@return Errorcode (EOK = no error)
+*/
+int hostuart_open(void);
+
+/*!
+Close the pty and write the statistics file ("ESPCMD_STATS")
+*/
+void hostuart_close(void);
+
+/*!
+Set the speed of the pty (the simulator compares it with the rate of the
+ESP8266, option "-a")
+@param uiBaudrate Baudrate [bit/s]
+@return Errorcode (EOK = no error)
+*/
+int hostuart_baudrate(uint32_t uiBaudrate);
+
+/*!
+Transmit bytes to the simulator
+@param pData Data to send
+@param uiSize Number of bytes
+@return Errorcode (EOK = no error)
+*/
+int hostuart_write(const void* pData, size_t uiSize);
+
+/*!
+Check, if received bytes are available (without waiting)
+@return Number of bytes available (at least)
+*/
+size_t hostuart_avail(void);
+
+/*!
+Receive one byte
+@param uiTimeout Maximum time to wait [ms]
+@return Received byte; negative values signaling a timeout
+*/
+int hostuart_getc(uint16_t uiTimeout);
+
+/*!
+Monotonic time of the host
+@return Time [us]
+*/
+uint64_t hostuart_micros(void);
+
+#endif /* __HOSTUART_H__ */
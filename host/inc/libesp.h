@@ -0,0 +1,147 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: libesp.h                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of "libesp" that talks to a pty (ESP8266 simulator)  |
+| instead of the UART of the ZX Spectrum Next                                  |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__LIBESP_H__)
+  #define __LIBESP_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Default baudrate of the ESP8266
+*/
+#define uiESP_DEFAULT_BAUDRATE (115200UL)
+
+/*!
+Default timeout of the communication with the ESP8266 [ms]
+*/
+#define uiESP_DEFAULT_TIMEOUT (2000)
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Classification of a received line
+*/
+typedef enum _espline
+{
+  ESP_LINE_TIMEOUT = 0,
+  ESP_LINE_DATA,
+  ESP_LINE_OK,
+  ESP_LINE_ERROR,
+  ESP_LINE_FAIL
+} espline_t;
+
+/*!
+Device data of a ESP connection
+*/
+typedef struct _esp
+{
+  /*!
+  Baudrate of the connection [bit/s]
+  */
+  uint32_t uiBaudrate;
+
+  /*!
+  Timeout of the connection [ms]
+  */
+  uint16_t uiTimeout;
+} esp_t;
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Open the connection to the ESP8266 (pty given by "ESPCMD_TTY")
+@param pEsp Device data
+@return Errorcode (EOK = no error)
+*/
+int esp_open(esp_t* pEsp);
+
+/*!
+Close the connection to the ESP8266
+@param pEsp Device data
+@return Errorcode (EOK = no error)
+*/
+int esp_close(esp_t* pEsp);
+
+/*!
+Set the baudrate of the connection
+@param pEsp Device data
+@param uiBaudrate Baudrate [bit/s]
+@return Errorcode (EOK = no error)
+*/
+int esp_set_baudrate(esp_t* pEsp, uint32_t uiBaudrate);
+
+/*!
+Set the timeout of the connection
+@param pEsp Device data
+@param uiTimeout Timeout [ms]
+@return Errorcode (EOK = no error)
+*/
+int esp_set_timeout(esp_t* pEsp, uint16_t uiTimeout);
+
+/*!
+Discard all pending received data
+@param pEsp Device data
+@return Errorcode (EOK = no error)
+*/
+int esp_flush(esp_t* pEsp);
+
+/*!
+Send a string to the ESP8266
+@param pEsp Device data
+@param acData Zero terminated string to send
+@return Errorcode (EOK = no error)
+*/
+int esp_transmit(esp_t* pEsp, const char_t* acData);
+
+/*!
+Receive one line from the ESP8266
+@param pEsp Device data
+@param acBuffer Buffer for the line (including CR/LF)
+@param uiSize Size of the buffer
+@return Classification of the line (ESP_LINE_...)
+*/
+int esp_receive_ex(esp_t* pEsp, char_t* acBuffer, uint16_t uiSize);
+
+#endif /* __LIBESP_H__ */
@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: libzxn.h                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of "libzxn" (subset used by the application)         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__LIBZXN_H__)
+  #define __LIBZXN_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Errorcodes of z88dk/libzxn that are not available on the host
+*/
+#if !defined(EOK)
+  #define EOK (0)
+#endif
+
+#if !defined(ESTAT)
+  #define ESTAT (0x7E)
+#endif
+
+#if !defined(ETIMEOUT)
+  #define ETIMEOUT (0x7F)
+#endif
+
+/*!
+Debug output
+*/
+#if defined(__DEBUG__)
+  #define DBGPRINTF(...) fprintf(stderr, __VA_ARGS__)
+#else
+  #define DBGPRINTF(...)
+#endif
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Character type of libzxn
+*/
+typedef char char_t;
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Read current CPU speed
+@return Speed (RTM_3MHZ, ..., RTM_28MHZ)
+*/
+uint8_t zxn_getspeed(void);
+
+/*!
+Set CPU speed
+@param uiSpeed Speed (RTM_3MHZ, ..., RTM_28MHZ)
+*/
+void zxn_setspeed(uint8_t uiSpeed);
+
+/*!
+Remove trailing whitespace (in place)
+@param acStr String to trim
+@return Pointer to the string
+*/
+char_t* zxn_rtrim(char_t* acStr);
+
+/*!
+Convert an errorcode into the exitcode of the application; on the host the
+message is printed to stderr and the errorcode is the process exit status.
+@param iCode Errorcode
+@return Exitcode
+*/
+int zxn_strerror(int iCode);
+
+#endif /* __LIBZXN_H__ */
@@ -0,0 +1,733 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espsim.c                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: ESP8266 simulator (AT firmware subset) on a pseudo terminal      |
+| with configurable response latency, line lengths and baudrate pacing         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <signal.h>
+#include <time.h>
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Maximum length of a received AT command
+*/
+#define uiSIM_MAX_LEN_CMD (0x400)
+
+/*!
+Number of bytes written at once when pacing the output
+*/
+#define uiSIM_PACE_CHUNK (16)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Configuration and state of the simulator
+*/
+static struct
+{
+  int      iMaster;     /* Master side of the pty                         */
+  int      iSlave;      /* Slave side (kept open to avoid EIO on master)  */
+  bool     bEcho;       /* ATE0/ATE1                                      */
+  uint32_t uiLatency;   /* Delay before each response [us]               */
+  uint32_t uiBaudrate;  /* Pacing of the output [bit/s]; 0 = unpaced      */
+  uint16_t uiLines;     /* Number of lines of bulk responses (CWLAP)      */
+  uint16_t uiLineLen;   /* Length of lines of bulk responses              */
+  bool     bVerbose;    /* Log received commands to stderr                */
+  uint32_t uiMaxBaud;   /* Highest working rate of AT+UART_CUR; 0 = all   */
+  bool     bGarbled;    /* Current rate exceeds "uiMaxBaud"               */
+  bool     bConnected;  /* TCP connection open (AT+CIPSTART)              */
+  int      iSink;       /* File of the data received by AT+CIPSEND        */
+  bool     bCipMode;    /* AT+CIPMODE=1 (transparent transmission)        */
+  const char* acSource; /* File served in transparent mode                */
+  bool     bRawPush;    /* Transparent mode: push the file without HTTP   */
+  uint16_t uiBusy;      /* Number of commands still rejected with "busy"  */
+  uint32_t uiBusyMs;    /* All commands (AT too) busy after the first [ms]*/
+  uint64_t uiBusyEnd;   /* End of the busy period [us]; 0 = not started   */
+  int      iIdleMsg;    /* Period of unsolicited messages [ms]; -1 = none */
+  uint32_t uiEspRate;   /* Rate of the ESP8266 (pty speed); 0 = any       */
+} g_tSim;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* sim_sleep()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sim_sleep(uint64_t uiMicros)
+{
+  struct timespec tWait;
+
+  if (uiMicros)
+  {
+    tWait.tv_sec  = (time_t) (uiMicros / 1000000u);
+    tWait.tv_nsec = (long) ((uiMicros % 1000000u) * 1000u);
+
+    while ((0 != nanosleep(&tWait, &tWait)) && (EINTR == errno))
+    {
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_micros()                                                               */
+/*----------------------------------------------------------------------------*/
+static uint64_t sim_micros(void)
+{
+  struct timespec tNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &tNow);
+
+  return ((uint64_t) tNow.tv_sec * 1000000u) + ((uint64_t) tNow.tv_nsec / 1000u);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_speed()                                                                */
+/*----------------------------------------------------------------------------*/
+static speed_t sim_speed(uint32_t uiRate)
+{
+  switch (uiRate)
+  {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1152000: return B1152000;
+    case 2000000: return B2000000;
+    default:      return B0;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_mismatch()                                                             */
+/*----------------------------------------------------------------------------*/
+static bool sim_mismatch(void)
+{
+  struct termios tTio;
+
+  /* The speed of the pty is the rate of the UART of the application */
+  return g_tSim.uiEspRate &&
+         (0 == tcgetattr(g_tSim.iSlave, &tTio)) &&
+         (cfgetospeed(&tTio) != sim_speed(g_tSim.uiEspRate));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_write()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sim_write(const void* pData, size_t uiSize)
+{
+  const uint8_t* pcData = (const uint8_t*) pData;
+  uint8_t acGarbage[uiSIM_PACE_CHUNK];
+
+  /* Rate too high for the link: the receiver sees only framing errors */
+  if (g_tSim.bGarbled)
+  {
+    memset(acGarbage, 0xFE, sizeof(acGarbage));
+  }
+
+  while (uiSize)
+  {
+    size_t uiChunk = (g_tSim.uiBaudrate || g_tSim.bGarbled) ? (uiSize < uiSIM_PACE_CHUNK ? uiSize : uiSIM_PACE_CHUNK) : uiSize;
+    ssize_t iWritten = write(g_tSim.iMaster, g_tSim.bGarbled ? acGarbage : pcData, uiChunk);
+
+    if (0 > iWritten)
+    {
+      if (EINTR == errno)
+      {
+        continue;
+      }
+
+      return;
+    }
+
+    /* 8N1: 10 bits per byte */
+    if (g_tSim.uiBaudrate)
+    {
+      sim_sleep(((uint64_t) iWritten * 10u * 1000000u) / g_tSim.uiBaudrate);
+    }
+
+    pcData += iWritten;
+    uiSize -= (size_t) iWritten;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_line()                                                                 */
+/*----------------------------------------------------------------------------*/
+static void sim_line(const char* acLine)
+{
+  sim_write(acLine, strlen(acLine));
+  sim_write("\r\n", 2);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_cwlap()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sim_cwlap(void)
+{
+  char acLine[0x1000];
+  size_t uiLen;
+
+  for (uint16_t i = 0; i < g_tSim.uiLines; ++i)
+  {
+    uiLen = (size_t) snprintf(acLine, sizeof(acLine),
+                              "+CWLAP:(3,\"simnet-%03u\",-%u,\"5c:cf:7f:00:%02x:%02x\",%u,",
+                              i, 40u + (i % 50u), (i >> 8) & 0xFF, i & 0xFF, 1u + (i % 13u));
+
+    /* Pad the line to the configured length */
+    while ((uiLen + 1u < g_tSim.uiLineLen) && (uiLen + 2u < sizeof(acLine)))
+    {
+      acLine[uiLen] = (char) ('0' + (uiLen % 10u));
+      ++uiLen;
+    }
+
+    acLine[uiLen++] = ')';
+    acLine[uiLen]   = '\0';
+
+    sim_line(acLine);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_cipsend()                                                              */
+/*----------------------------------------------------------------------------*/
+static void sim_cipsend(size_t uiSize)
+{
+  char acLine[0x40];
+  uint8_t acData[0x400];
+  size_t uiDone = 0;
+
+  if (!g_tSim.bConnected || (0 == uiSize) || (2048 < uiSize))
+  {
+    sim_line("");
+    sim_line("ERROR");
+    return;
+  }
+
+  sim_line("");
+  sim_line("OK");
+  sim_write("> ", 2);
+
+  /* Raw data of the announced length */
+  while (uiDone < uiSize)
+  {
+    size_t uiChunk = uiSize - uiDone;
+    ssize_t iRead = read(g_tSim.iMaster, acData, uiChunk < sizeof(acData) ? uiChunk : sizeof(acData));
+
+    if (0 >= iRead)
+    {
+      if ((0 > iRead) && (EINTR == errno))
+      {
+        continue;
+      }
+
+      return;
+    }
+
+    if ((0 <= g_tSim.iSink) && (iRead != write(g_tSim.iSink, acData, (size_t) iRead)))
+    {
+      perror("espsim: sink");
+    }
+
+    uiDone += (size_t) iRead;
+  }
+
+  sim_sleep(g_tSim.uiLatency);
+
+  snprintf(acLine, sizeof(acLine), "Recv %zu bytes", uiSize);
+  sim_line("");
+  sim_line(acLine);
+  sim_line("");
+  sim_line("SEND OK");
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_serve()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sim_serve(bool bHttp)
+{
+  char acHeader[0x80];
+  uint8_t acData[0x400];
+  struct stat tStat;
+  ssize_t iRead;
+  int iFd = g_tSim.acSource ? open(g_tSim.acSource, O_RDONLY) : -1;
+
+  if ((0 > iFd) || (0 != fstat(iFd, &tStat)))
+  {
+    if (bHttp)
+    {
+      static const char acNotFound[] = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+      sim_write(acNotFound, sizeof(acNotFound) - 1);
+    }
+
+    if (0 <= iFd)
+    {
+      close(iFd);
+    }
+
+    return;
+  }
+
+  if (bHttp)
+  {
+    int iLen = snprintf(acHeader, sizeof(acHeader),
+                        "HTTP/1.0 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                        "Content-Length: %lld\r\n\r\n", (long long) tStat.st_size);
+    sim_write(acHeader, (size_t) iLen);
+  }
+
+  while (0 < (iRead = read(iFd, acData, sizeof(acData))))
+  {
+    sim_write(acData, (size_t) iRead);
+  }
+
+  close(iFd);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_transparent()                                                          */
+/*----------------------------------------------------------------------------*/
+/*
+Transparent transmission until "+++" arrives as a packet of its own
+*/
+static void sim_transparent(void)
+{
+  char acRequest[0x400];
+  size_t uiLen = 0;
+
+  if (g_tSim.bRawPush)
+  {
+    sim_serve(false);
+  }
+
+  for ( ; ; )
+  {
+    ssize_t iRead = read(g_tSim.iMaster, &acRequest[uiLen], sizeof(acRequest) - 1 - uiLen);
+
+    if (0 >= iRead)
+    {
+      if ((0 > iRead) && (EINTR == errno))
+      {
+        continue;
+      }
+
+      return;
+    }
+
+    if ((3 == iRead) && (0 == memcmp(&acRequest[uiLen], "+++", 3)))
+    {
+      return;
+    }
+
+    uiLen += (size_t) iRead;
+    acRequest[uiLen] = '\0';
+
+    if (strstr(acRequest, "\r\n\r\n") || (sizeof(acRequest) - 1 == uiLen))
+    {
+      if (0 == strncmp(acRequest, "GET ", 4))
+      {
+        sim_serve(true);
+      }
+
+      uiLen = 0;
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_command()                                                              */
+/*----------------------------------------------------------------------------*/
+static void sim_command(const char* acCmd)
+{
+  if (g_tSim.bVerbose)
+  {
+    fprintf(stderr, "espsim: %s\n", acCmd);
+  }
+
+  if (g_tSim.bEcho)
+  {
+    sim_write(acCmd, strlen(acCmd));
+    sim_write("\r\r\n", 3);
+  }
+
+  sim_sleep(g_tSim.uiLatency);
+
+  /* Busy with a long operation: every command is dropped, "AT" too */
+  if (g_tSim.uiBusyMs && (0 == g_tSim.uiBusyEnd))
+  {
+    g_tSim.uiBusyEnd = sim_micros() + ((uint64_t) g_tSim.uiBusyMs * 1000u);
+  }
+
+  if (g_tSim.uiBusyEnd && (sim_micros() < g_tSim.uiBusyEnd))
+  {
+    sim_line("busy p...");
+    return;
+  }
+
+  /* Still busy with a previous operation: the command is dropped */
+  if (g_tSim.uiBusy && (0 != strcasecmp(acCmd, "AT")))
+  {
+    --g_tSim.uiBusy;
+    sim_line("busy p...");
+    return;
+  }
+
+  if (0 == strcasecmp(acCmd, "AT"))
+  {
+    sim_line("");
+    sim_line("OK");
+  }
+  else if ((0 == strcasecmp(acCmd, "ATE0")) || (0 == strcasecmp(acCmd, "ATE1")))
+  {
+    g_tSim.bEcho = ('1' == acCmd[3]);
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+GMR"))
+  {
+    sim_line("AT version:1.7.4.0(May 11 2020 19:13:04)");
+    sim_line("SDK version:3.0.4(9532ceb)");
+    sim_line("compile time:May 27 2020 10:12:22");
+    sim_line("Bin version(Wroom 02):1.7.4");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+CWLAP"))
+  {
+    sim_cwlap();
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+CIFSR"))
+  {
+    sim_line("+CIFSR:STAIP,\"192.168.1.23\"");
+    sim_line("+CIFSR:STAMAC,\"5c:cf:7f:12:34:56\"");
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+CWJAP?"))
+  {
+    sim_line("+CWJAP:\"simnet\",\"5c:cf:7f:00:00:01\",6,-55");
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+CIPSTATUS"))
+  {
+    sim_line(g_tSim.bConnected ? "STATUS:3" : "STATUS:2");
+
+    if (g_tSim.bConnected)
+    {
+      sim_line("+CIPSTATUS:0,\"TCP\",\"192.168.1.10\",8080,52012,0");
+    }
+
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strncasecmp(acCmd, "AT+CWJAP=", 9))
+  {
+    sim_line("WIFI CONNECTED");
+    sim_sleep(10u * g_tSim.uiLatency);
+    sim_line("WIFI GOT IP");
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+RST"))
+  {
+    sim_line("");
+    sim_line("OK");
+    static const char acBoot[] = "\x1a\xe3\x84\x0c\xf2 ets Jan  8 2013,rst cause:2, boot mode:(3,6)\r\n";
+    sim_write(acBoot, sizeof(acBoot) - 1);
+    sim_line("");
+    sim_line("ready");
+  }
+  else if (0 == strncasecmp(acCmd, "AT+UART_CUR=", 12))
+  {
+    uint32_t uiRate = (uint32_t) strtoul(&acCmd[12], 0, 10);
+
+    sim_line("");
+    sim_line("OK");
+
+    /* Switch after "OK" */
+    if (g_tSim.uiBaudrate)
+    {
+      g_tSim.uiBaudrate = uiRate;
+    }
+
+    g_tSim.bGarbled = g_tSim.uiMaxBaud && (uiRate > g_tSim.uiMaxBaud);
+
+    if (g_tSim.uiEspRate)
+    {
+      g_tSim.uiEspRate = uiRate;
+    }
+  }
+  else if (0 == strncasecmp(acCmd, "AT+CIPMUX=", 10))
+  {
+    sim_line("");
+    sim_line(g_tSim.bConnected ? "link is builded" : "");
+    sim_line(g_tSim.bConnected ? "ERROR" : "OK");
+  }
+  else if (0 == strncasecmp(acCmd, "AT+CIPSTART=", 12))
+  {
+    if (g_tSim.bConnected)
+    {
+      sim_line("ALREADY CONNECTED");
+      sim_line("");
+      sim_line("ERROR");
+    }
+    else
+    {
+      g_tSim.bConnected = true;
+      sim_line("CONNECT");
+      sim_line("");
+      sim_line("OK");
+    }
+  }
+  else if (0 == strncasecmp(acCmd, "AT+CIPMODE=", 11))
+  {
+    g_tSim.bCipMode = ('1' == acCmd[11]);
+    sim_line("");
+    sim_line("OK");
+  }
+  else if (0 == strcasecmp(acCmd, "AT+CIPSEND"))
+  {
+    if (g_tSim.bCipMode && g_tSim.bConnected)
+    {
+      sim_line("");
+      sim_line("OK");
+      sim_line("");
+      sim_write(">", 1);
+      sim_transparent();
+    }
+    else
+    {
+      sim_line("");
+      sim_line("ERROR");
+    }
+  }
+  else if (0 == strncasecmp(acCmd, "AT+CIPSEND=", 11))
+  {
+    sim_cipsend((size_t) strtoul(&acCmd[11], 0, 10));
+  }
+  else if (0 == strcasecmp(acCmd, "AT+CIPCLOSE"))
+  {
+    sim_line(g_tSim.bConnected ? "CLOSED" : "");
+    sim_line("");
+    sim_line(g_tSim.bConnected ? "OK" : "ERROR");
+    g_tSim.bConnected = false;
+  }
+  else if (0 == strcasecmp(acCmd, "AT+SIMFAIL"))
+  {
+    sim_line("FAIL");
+  }
+  else if ('\0' != acCmd[0])
+  {
+    sim_line("");
+    sim_line("ERROR");
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sim_usage()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sim_usage(void)
+{
+  fprintf(stderr,
+          "usage: espsim [-l latency_us][-b baudrate][-m baudrate][-n lines][-w width][-o file][-i file][-r][-y n][-Y ms][-u ms][-a baudrate][-E][-v]\n"
+          " -l  delay before each response in [us] (default: 0)\n"
+          " -b  pace output to the given baudrate (default: 0 = unpaced)\n"
+          " -m  highest working rate of AT+UART_CUR (default: 0 = all)\n"
+          " -n  number of lines of AT+CWLAP (default: 10)\n"
+          " -w  length of the lines of AT+CWLAP (default: 60)\n"
+          " -o  file for the data received by AT+CIPSEND\n"
+          " -i  file served in transparent mode (HTTP GET)\n"
+          " -r  push the file of -i without HTTP\n"
+          " -y  reject the first n commands (except AT) with \"busy p...\"\n"
+          " -Y  reject all commands (AT too) for ms after the first one\n"
+          " -u  unsolicited message (\"WIFI GOT IP\") after ms without commands\n"
+          " -a  rate of the ESP8266; other pty speeds are garbled (default: 0 = any)\n"
+          " -E  echo off (ATE0) at startup\n"
+          " -v  log received commands to stderr\n"
+          "The name of the pty is printed to stdout.\n");
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* main()                                                                     */
+/*----------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+  char acCmd[uiSIM_MAX_LEN_CMD];
+  size_t uiLen = 0;
+  struct termios tTio;
+  int iOpt;
+
+  g_tSim.bEcho     = true;
+  g_tSim.uiLines   = 10;
+  g_tSim.uiLineLen = 60;
+  g_tSim.iSink     = -1;
+  g_tSim.iIdleMsg  = -1;
+
+  while (-1 != (iOpt = getopt(argc, argv, "l:b:m:n:w:o:i:ry:Y:u:a:Evh")))
+  {
+    switch (iOpt)
+    {
+      case 'l': g_tSim.uiLatency  = (uint32_t) strtoul(optarg, 0, 0); break;
+      case 'b': g_tSim.uiBaudrate = (uint32_t) strtoul(optarg, 0, 0); break;
+      case 'm': g_tSim.uiMaxBaud  = (uint32_t) strtoul(optarg, 0, 0); break;
+      case 'n': g_tSim.uiLines    = (uint16_t) strtoul(optarg, 0, 0); break;
+      case 'w': g_tSim.uiLineLen  = (uint16_t) strtoul(optarg, 0, 0); break;
+      case 'o': g_tSim.iSink      = open(optarg, O_WRONLY | O_CREAT | O_TRUNC, 0644); break;
+      case 'i': g_tSim.acSource   = optarg;                           break;
+      case 'r': g_tSim.bRawPush   = true;                             break;
+      case 'y': g_tSim.uiBusy     = (uint16_t) strtoul(optarg, 0, 0); break;
+      case 'Y': g_tSim.uiBusyMs   = (uint32_t) strtoul(optarg, 0, 0); break;
+      case 'u': g_tSim.iIdleMsg   = (int) strtoul(optarg, 0, 0);      break;
+      case 'a': g_tSim.uiEspRate  = (uint32_t) strtoul(optarg, 0, 0); break;
+      case 'E': g_tSim.bEcho      = false;                            break;
+      case 'v': g_tSim.bVerbose   = true;                             break;
+      default:  sim_usage();                                          return 1;
+    }
+  }
+
+  if ((0 > (g_tSim.iMaster = posix_openpt(O_RDWR | O_NOCTTY))) ||
+      (0 != grantpt(g_tSim.iMaster)) ||
+      (0 != unlockpt(g_tSim.iMaster)) ||
+      (0 > (g_tSim.iSlave = open(ptsname(g_tSim.iMaster), O_RDWR | O_NOCTTY))))
+  {
+    perror("espsim: pty");
+    return 1;
+  }
+
+  if (0 == tcgetattr(g_tSim.iSlave, &tTio))
+  {
+    cfmakeraw(&tTio);
+    tcsetattr(g_tSim.iSlave, TCSANOW, &tTio);
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+
+  printf("%s\n", ptsname(g_tSim.iMaster));
+  fflush(stdout);
+
+  for ( ; ; )
+  {
+    struct pollfd tPoll = { .fd = g_tSim.iMaster, .events = POLLIN };
+    char c;
+    ssize_t iRead;
+
+    /* Idle between commands: unsolicited message */
+    if ((0 == uiLen) && (0 == poll(&tPoll, 1, g_tSim.iIdleMsg)))
+    {
+      sim_write("WIFI GOT IP\r\n", 13);
+      continue;
+    }
+
+    iRead = read(g_tSim.iMaster, &c, 1);
+
+    if (0 >= iRead)
+    {
+      if ((0 > iRead) && (EINTR == errno))
+      {
+        continue;
+      }
+
+      break;
+    }
+
+    /* Commands end with CR/LF (raw data of AT+CIPSEND follows the LF) */
+    if ('\r' == c)
+    {
+      continue;
+    }
+
+    if ('\n' == c)
+    {
+      if (uiLen && sim_mismatch())
+      {
+        /* Wrong rate: framing errors instead of a response */
+        sim_write("\xF8\x80\xFE", 3);
+        uiLen = 0;
+      }
+      else if (uiLen)
+      {
+        acCmd[uiLen] = '\0';
+        sim_command(acCmd);
+        uiLen = 0;
+      }
+    }
+    else if (uiLen < (sizeof(acCmd) - 1))
+    {
+      acCmd[uiLen++] = c;
+    }
+  }
+
+  return 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,192 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostesp.c                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of "libesp" that talks to a pty (ESP8266 simulator)  |
+| instead of the UART of the ZX Spectrum Next                                  |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "libzxn.h"
+#include "libesp.h"
+#include "hostuart.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Time without received data, that signals an idle line in "esp_flush" [ms]
+*/
+#define uiHOSTESP_FLUSH_IDLE (20)
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* esp_open()                                                                 */
+/*----------------------------------------------------------------------------*/
+int esp_open(esp_t* pEsp)
+{
+  pEsp->uiBaudrate = uiESP_DEFAULT_BAUDRATE;
+  pEsp->uiTimeout  = uiESP_DEFAULT_TIMEOUT;
+
+  return hostuart_open();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esp_close()                                                                */
+/*----------------------------------------------------------------------------*/
+int esp_close(esp_t* pEsp)
+{
+  (void) pEsp;
+  hostuart_close();
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esp_set_baudrate()                                                         */
+/*----------------------------------------------------------------------------*/
+int esp_set_baudrate(esp_t* pEsp, uint32_t uiBaudrate)
+{
+  if (!uiBaudrate)
+  {
+    return EINVAL;
+  }
+
+  pEsp->uiBaudrate = uiBaudrate;
+
+  /* Rates without termios speed are not checked by the simulator */
+  hostuart_baudrate(uiBaudrate);
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esp_set_timeout()                                                          */
+/*----------------------------------------------------------------------------*/
+int esp_set_timeout(esp_t* pEsp, uint16_t uiTimeout)
+{
+  pEsp->uiTimeout = uiTimeout;
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esp_flush()                                                                */
+/*----------------------------------------------------------------------------*/
+int esp_flush(esp_t* pEsp)
+{
+  (void) pEsp;
+
+  while (0 <= hostuart_getc(uiHOSTESP_FLUSH_IDLE))
+  {
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esp_transmit()                                                             */
+/*----------------------------------------------------------------------------*/
+int esp_transmit(esp_t* pEsp, const char_t* acData)
+{
+  (void) pEsp;
+
+  return hostuart_write(acData, strlen(acData));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esp_receive_ex()                                                           */
+/*----------------------------------------------------------------------------*/
+int esp_receive_ex(esp_t* pEsp, char_t* acBuffer, uint16_t uiSize)
+{
+  uint16_t uiLen = 0;
+  int iByte;
+
+  if (2 > uiSize)
+  {
+    return ESP_LINE_TIMEOUT;
+  }
+
+  while (uiLen < (uiSize - 1))
+  {
+    if (0 > (iByte = hostuart_getc(pEsp->uiTimeout)))
+    {
+      acBuffer[uiLen] = '\0';
+      return ESP_LINE_TIMEOUT;
+    }
+
+    acBuffer[uiLen++] = (char_t) iByte;
+
+    if ('\n' == iByte)
+    {
+      break;
+    }
+  }
+
+  acBuffer[uiLen] = '\0';
+
+  if ((0 == strcmp(acBuffer, "OK\r\n")) || (0 == strcmp(acBuffer, "OK\n")))
+  {
+    return ESP_LINE_OK;
+  }
+
+  if ((0 == strcmp(acBuffer, "ERROR\r\n")) || (0 == strcmp(acBuffer, "ERROR\n")))
+  {
+    return ESP_LINE_ERROR;
+  }
+
+  if ((0 == strcmp(acBuffer, "FAIL\r\n")) || (0 == strcmp(acBuffer, "FAIL\n")))
+  {
+    return ESP_LINE_FAIL;
+  }
+
+  return ESP_LINE_DATA;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,437 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostespuart.c                                                      |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of "espuart.c" (UART of the ZX Spectrum Next)        |
+| that reads from the pty of the ESP8266 simulator                             |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+
+#include "libzxn.h"
+#include "espuart.h"
+#include "hostuart.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Period of the simulated receive interrupt [us]
+*/
+#define uiHOSTESPUART_IRQ_PERIOD (1000)
+
+/*!
+Level of the simulated receive FIFO (3/4 of 512 bytes), at which a read counts
+as throttled
+*/
+#define uiHOSTESPUART_NEAR_FULL (384)
+
+/*!
+RAMTOP of the simulated BASIC ("CLEAR 49151"): the memory above is free
+*/
+#define uiHOSTESPUART_RAMTOP (0xBFFF)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Counters of the simulated receive FIFO; the pty loses no data
+*/
+static espuart_stats_t g_tStats;
+
+/*!
+Simulated receive interrupt: a thread calls the handler periodically; the
+mutex replaces "di"/"ei"
+*/
+static struct
+{
+  pthread_mutex_t   tLock;
+  pthread_t         tThread;
+  espuart_handler_t pfnHandler;
+  volatile bool     bRunning;
+} g_tIrq = { .tLock = PTHREAD_MUTEX_INITIALIZER };
+
+/*!
+Simulated memory pages of "espuart_map" (allocated on first use)
+*/
+static uint8_t* g_apPage[0x100];
+
+/*!
+Page of the window of "espuart_map" (0xFF = none)
+*/
+static uint8_t g_uiWindow = 0xFF;
+
+/*!
+Simulated memory of BASIC ("espuart_memory"); written to the file named by
+the environment variable "ESPCMD_MEM" at the end of the application
+*/
+static uint8_t* g_pMemory;
+
+/*!
+Keyboard of "espuart_key": settings of the terminal before the first call
+*/
+static struct
+{
+  struct termios tSaved;
+  bool bRaw;
+} g_tKbd;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espuart_read()                                                             */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_read(uint8_t* pDst, uint16_t uiSize)
+{
+  uint16_t uiCount = 0;
+
+  if (uiHOSTESPUART_NEAR_FULL <= hostuart_avail())
+  {
+    ++g_tStats.uiThrottled;
+  }
+
+  while ((uiCount < uiSize) && hostuart_avail())
+  {
+    pDst[uiCount++] = (uint8_t) hostuart_getc(0);
+  }
+
+  return uiCount;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_stats()                                                            */
+/*----------------------------------------------------------------------------*/
+void espuart_stats(espuart_stats_t* pStats)
+{
+  *pStats = g_tStats;
+  g_tStats.uiThrottled = 0;
+  g_tStats.uiOverruns  = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_flow()                                                             */
+/*----------------------------------------------------------------------------*/
+void espuart_flow(bool bEnable)
+{
+  /* The pty has no flow control */
+  (void) bEnable;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_write()                                                            */
+/*----------------------------------------------------------------------------*/
+void espuart_write(const uint8_t* pSrc, uint16_t uiSize)
+{
+  hostuart_write(pSrc, uiSize);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_clock()                                                            */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_clock(void)
+{
+  return (uint16_t) (hostuart_micros() / 1000u);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_seconds()                                                          */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_seconds(void)
+{
+  struct timespec tNow;
+
+  /* CLOCK_MONOTONIC continues across processes (like "FRAMES" on the Next) */
+  clock_gettime(CLOCK_MONOTONIC, &tNow);
+
+  return (uint16_t) tNow.tv_sec;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_micros()                                                           */
+/*----------------------------------------------------------------------------*/
+uint32_t espuart_micros(void)
+{
+  return (uint32_t) hostuart_micros();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_ticks()                                                            */
+/*----------------------------------------------------------------------------*/
+uint32_t espuart_ticks(void)
+{
+  return (uint32_t) hostuart_micros();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_ticks_us()                                                         */
+/*----------------------------------------------------------------------------*/
+uint32_t espuart_ticks_us(uint32_t uiTicks)
+{
+  return uiTicks;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_irq_thread()                                                       */
+/*----------------------------------------------------------------------------*/
+static void* espuart_irq_thread(void* pArg)
+{
+  (void) pArg;
+
+  while (g_tIrq.bRunning)
+  {
+    usleep(uiHOSTESPUART_IRQ_PERIOD);
+
+    pthread_mutex_lock(&g_tIrq.tLock);
+    g_tIrq.pfnHandler();
+    pthread_mutex_unlock(&g_tIrq.tLock);
+  }
+
+  return 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_irq_enable()                                                       */
+/*----------------------------------------------------------------------------*/
+int espuart_irq_enable(espuart_handler_t pfnHandler)
+{
+  if (g_tIrq.bRunning)
+  {
+    return EOK;
+  }
+
+  g_tIrq.pfnHandler = pfnHandler;
+  g_tIrq.bRunning   = true;
+
+  if (0 != pthread_create(&g_tIrq.tThread, 0, espuart_irq_thread, 0))
+  {
+    g_tIrq.bRunning = false;
+    return ENOMEM;
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_irq_disable()                                                      */
+/*----------------------------------------------------------------------------*/
+void espuart_irq_disable(void)
+{
+  if (g_tIrq.bRunning)
+  {
+    g_tIrq.bRunning = false;
+    pthread_join(g_tIrq.tThread, 0);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_map()                                                              */
+/*----------------------------------------------------------------------------*/
+uint8_t* espuart_map(uint8_t uiPage)
+{
+  if (!g_apPage[uiPage])
+  {
+    g_apPage[uiPage] = calloc(1, uiESPUART_PAGE_SIZE);
+  }
+
+  g_uiWindow = uiPage;
+
+  return g_apPage[uiPage];
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_unmap()                                                            */
+/*----------------------------------------------------------------------------*/
+void espuart_unmap(void)
+{
+  g_uiWindow = 0xFF;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_mapped()                                                           */
+/*----------------------------------------------------------------------------*/
+uint8_t espuart_mapped(void)
+{
+  return g_uiWindow;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_ramtop()                                                           */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_ramtop(void)
+{
+  return uiHOSTESPUART_RAMTOP;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_memory_dump()                                                      */
+/*----------------------------------------------------------------------------*/
+static void espuart_memory_dump(void)
+{
+  const char* acFile = getenv("ESPCMD_MEM");
+  FILE* pFile;
+
+  if (acFile && (0 != (pFile = fopen(acFile, "wb"))))
+  {
+    fwrite(g_pMemory, 1, 0x10000, pFile);
+    fclose(pFile);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_memory()                                                           */
+/*----------------------------------------------------------------------------*/
+uint8_t* espuart_memory(uint16_t uiAddress)
+{
+  if (!g_pMemory)
+  {
+    g_pMemory = calloc(1, 0x10000);
+    atexit(espuart_memory_dump);
+  }
+
+  return &g_pMemory[uiAddress];
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_kbd_restore()                                                      */
+/*----------------------------------------------------------------------------*/
+static void espuart_kbd_restore(void)
+{
+  tcsetattr(STDIN_FILENO, TCSANOW, &g_tKbd.tSaved);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_key()                                                              */
+/*----------------------------------------------------------------------------*/
+uint8_t espuart_key(void)
+{
+  struct pollfd tPoll = { .fd = STDIN_FILENO, .events = POLLIN };
+  struct termios tRaw;
+  uint8_t acSeq[2];
+  uint8_t c;
+
+  /* Terminal: characters without line buffering and echo (like the Next) */
+  if (!g_tKbd.bRaw && isatty(STDIN_FILENO) && (0 == tcgetattr(STDIN_FILENO, &g_tKbd.tSaved)))
+  {
+    tRaw = g_tKbd.tSaved;
+    tRaw.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &tRaw);
+    atexit(espuart_kbd_restore);
+  }
+
+  g_tKbd.bRaw = true;
+
+  if (1 != poll(&tPoll, 1, 0))
+  {
+    return 0;
+  }
+
+  if (1 != read(STDIN_FILENO, &c, 1))
+  {
+    return uiESPUART_KEY_END;
+  }
+
+  switch (c)
+  {
+    case '\n':
+    case '\r':
+      return uiESPUART_KEY_ENTER;
+
+    case 0x08:
+    case 0x7F:
+      return uiESPUART_KEY_DELETE;
+
+    case 0x1B: /* Cursor keys: ESC [ A/B */
+      if ((2 == read(STDIN_FILENO, acSeq, 2)) && ('[' == acSeq[0]))
+      {
+        return ('A' == acSeq[1]) ? uiESPUART_KEY_UP : (('B' == acSeq[1]) ? uiESPUART_KEY_DOWN : 0);
+      }
+      return 0;
+
+    default:
+      return c;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_lock()                                                             */
+/*----------------------------------------------------------------------------*/
+void espuart_lock(void)
+{
+  pthread_mutex_lock(&g_tIrq.tLock);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_unlock()                                                           */
+/*----------------------------------------------------------------------------*/
+void espuart_unlock(void)
+{
+  pthread_mutex_unlock(&g_tIrq.tLock);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,237 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostesxdos.c                                                       |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of the esxDOS file API by POSIX files                |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <arch/zxn/esxdos.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+First page and number of pages handed out by "esx_ide_bank_alloc"
+*/
+#define uiHOSTESXDOS_FIRST_PAGE (0x40)
+#define uiHOSTESXDOS_PAGES      (16)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Allocated pages (bit per page)
+*/
+static uint16_t g_uiPages = 0;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_open()                                                               */
+/*----------------------------------------------------------------------------*/
+uint8_t esx_f_open(const char* pcName, uint8_t uiMode)
+{
+  int iFlags = 0;
+  int iFd;
+
+  switch (uiMode & (ESX_MODE_READ | ESX_MODE_WRITE))
+  {
+    case ESX_MODE_WRITE:                  iFlags = O_WRONLY; break;
+    case ESX_MODE_READ | ESX_MODE_WRITE:  iFlags = O_RDWR;   break;
+    default:                              iFlags = O_RDONLY; break;
+  }
+
+  switch (uiMode & ESX_MODE_OPEN_CREAT_TRUNC)
+  {
+    case ESX_MODE_OPEN_CREAT:          iFlags |= O_CREAT;           break;
+    case ESX_MODE_OPEN_CREAT_NOEXIST:  iFlags |= O_CREAT | O_EXCL;  break;
+    case ESX_MODE_OPEN_CREAT_TRUNC:    iFlags |= O_CREAT | O_TRUNC; break;
+    default:                                                        break;
+  }
+
+  /* Handles of esxDOS are 8 bit; 0xFF signals an error */
+  if ((0 > (iFd = open(pcName, iFlags, 0644))) || (0xFF <= iFd))
+  {
+    if (0 <= iFd)
+    {
+      close(iFd);
+    }
+
+    return 0xFF;
+  }
+
+  return (uint8_t) iFd;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_read()                                                               */
+/*----------------------------------------------------------------------------*/
+size_t esx_f_read(uint8_t hFile, void* pDst, size_t uiSize)
+{
+  ssize_t iRead = read(hFile, pDst, uiSize);
+
+  /* Like esxDOS: 0xFFFF signals an error */
+  return (0 > iRead) ? 0xFFFF : (size_t) iRead;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_write()                                                              */
+/*----------------------------------------------------------------------------*/
+size_t esx_f_write(uint8_t hFile, const void* pSrc, size_t uiSize)
+{
+  ssize_t iWritten = write(hFile, pSrc, uiSize);
+  return (0 > iWritten) ? 0 : (size_t) iWritten;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_seek()                                                               */
+/*----------------------------------------------------------------------------*/
+int esx_f_seek(uint8_t hFile, uint32_t uiOffset, uint8_t uiWhence)
+{
+  off_t iResult;
+
+  switch (uiWhence)
+  {
+    case ESX_SEEK_FWD: iResult = lseek(hFile, (off_t) uiOffset, SEEK_CUR);    break;
+    case ESX_SEEK_BWD: iResult = lseek(hFile, -(off_t) uiOffset, SEEK_CUR);   break;
+    case ESX_SEEK_END: iResult = lseek(hFile, -(off_t) uiOffset, SEEK_END);   break;
+    default:           iResult = lseek(hFile, (off_t) uiOffset, SEEK_SET);    break;
+  }
+
+  return (0 > iResult) ? -1 : 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_close()                                                              */
+/*----------------------------------------------------------------------------*/
+int esx_f_close(uint8_t hFile)
+{
+  return close(hFile);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_fstat()                                                              */
+/*----------------------------------------------------------------------------*/
+uint8_t esx_f_fstat(uint8_t hFile, struct esx_stat* pStat)
+{
+  struct stat tStat;
+  struct tm tTime;
+
+  if (0 != fstat(hFile, &tStat))
+  {
+    return 0xFF;
+  }
+
+  memset(pStat, 0, sizeof(*pStat));
+  pStat->size = (uint32_t) tStat.st_size;
+
+  /* Time of the last modification in the format of MS-DOS */
+  if (0 != localtime_r(&tStat.st_mtime, &tTime))
+  {
+    pStat->time.time = (uint16_t) ((tTime.tm_hour << 11) | (tTime.tm_min << 5) | (tTime.tm_sec / 2));
+    pStat->time.date = (uint16_t) (((tTime.tm_year - 80) << 9) | ((tTime.tm_mon + 1) << 5) | tTime.tm_mday);
+  }
+
+  return 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_f_unlink()                                                             */
+/*----------------------------------------------------------------------------*/
+int esx_f_unlink(const char* pcName)
+{
+  return unlink(pcName);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_m_dosversion()                                                         */
+/*----------------------------------------------------------------------------*/
+uint16_t esx_m_dosversion(void)
+{
+  return 0x0202; /* NextOS 2.02 */
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_ide_bank_alloc()                                                       */
+/*----------------------------------------------------------------------------*/
+uint8_t esx_ide_bank_alloc(uint8_t uiBankType)
+{
+  uint8_t i;
+
+  for (i = 0; (ESX_BANKTYPE_RAM == uiBankType) && (i < uiHOSTESXDOS_PAGES); ++i)
+  {
+    if (!(g_uiPages & (1u << i)))
+    {
+      g_uiPages |= (1u << i);
+      return uiHOSTESXDOS_FIRST_PAGE + i;
+    }
+  }
+
+  return 0xFF;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esx_ide_bank_free()                                                        */
+/*----------------------------------------------------------------------------*/
+uint8_t esx_ide_bank_free(uint8_t uiBankType, uint8_t uiPage)
+{
+  (void) uiBankType;
+
+  g_uiPages &= ~(1u << (uiPage - uiHOSTESXDOS_FIRST_PAGE));
+
+  return 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
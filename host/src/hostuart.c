@@ -0,0 +1,420 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostuart.c                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: byte stream to the ESP8266 simulator (pty) including the         |
+| measurement of round trip times for the benchmark                            |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "libzxn.h"
+#include "hostuart.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Size of the receive buffer of the host UART
+*/
+#define uiHOSTUART_RX_SIZE (0x1000)
+
+/*!
+Number of characters of a line used for the detection of final responses
+*/
+#define uiHOSTUART_LINE_HEAD (0x10)
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Measurement of one request (transmit until final response)
+*/
+typedef struct _hostsample
+{
+  uint64_t uiTx;     /*!< First byte of the request transmitted [us]  */
+  uint64_t uiFirst;  /*!< First byte of the response received [us]   */
+  uint64_t uiFinal;  /*!< Final response (OK/ERROR/...) received [us] */
+  uint32_t uiBytes;  /*!< Number of received bytes                     */
+  bool     bOk;      /*!< Final response was "OK"/"SEND OK"            */
+} hostsample_t;
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Data of the host UART
+*/
+static struct
+{
+  int iFd;
+
+  uint8_t  acRx[uiHOSTUART_RX_SIZE];
+  size_t   uiRxPos;
+  size_t   uiRxFill;
+
+  /* Detection of final responses */
+  char     acLine[uiHOSTUART_LINE_HEAD];
+  size_t   uiLineLen;
+
+  /* Measurements */
+  bool          bTxPending;  /* Bytes transmitted, request not complete */
+  bool          bArmed;      /* Request complete (CR/LF transmitted)    */
+  hostsample_t  tCurrent;
+  hostsample_t* pSamples;
+  size_t        uiSamples;
+  size_t        uiCapacity;
+} g_tUart = { .iFd = -1 };
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_micros()                                                          */
+/*----------------------------------------------------------------------------*/
+uint64_t hostuart_micros(void)
+{
+  struct timespec tNow;
+  clock_gettime(CLOCK_MONOTONIC, &tNow);
+  return ((uint64_t) tNow.tv_sec * 1000000u) + ((uint64_t) tNow.tv_nsec / 1000u);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_open()                                                            */
+/*----------------------------------------------------------------------------*/
+int hostuart_open(void)
+{
+  const char* pcTty = getenv(acHOSTUART_ENV_TTY);
+  struct termios tTio;
+
+  if (!pcTty)
+  {
+    fprintf(stderr, "hostuart: environment variable %s not set\n", acHOSTUART_ENV_TTY);
+    return ENOTSUP;
+  }
+
+  if (0 > (g_tUart.iFd = open(pcTty, O_RDWR | O_NOCTTY)))
+  {
+    fprintf(stderr, "hostuart: cannot open %s (%s)\n", pcTty, strerror(errno));
+    return ENOTSUP;
+  }
+
+  if (0 == tcgetattr(g_tUart.iFd, &tTio))
+  {
+    cfmakeraw(&tTio);
+    tcsetattr(g_tUart.iFd, TCSANOW, &tTio);
+  }
+
+  g_tUart.uiRxPos  = 0;
+  g_tUart.uiRxFill = 0;
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_close()                                                           */
+/*----------------------------------------------------------------------------*/
+void hostuart_close(void)
+{
+  const char* pcStats = getenv(acHOSTUART_ENV_STATS);
+  FILE* pFile;
+
+  if (0 <= g_tUart.iFd)
+  {
+    close(g_tUart.iFd);
+    g_tUart.iFd = -1;
+  }
+
+  if (pcStats && (0 != (pFile = fopen(pcStats, "w"))))
+  {
+    for (size_t i = 0; i < g_tUart.uiSamples; ++i)
+    {
+      const hostsample_t* pSample = &g_tUart.pSamples[i];
+      fprintf(pFile, "%llu %llu %llu %lu %d\n",
+              (unsigned long long) pSample->uiTx,
+              (unsigned long long) pSample->uiFirst,
+              (unsigned long long) pSample->uiFinal,
+              (unsigned long) pSample->uiBytes,
+              pSample->bOk ? 1 : 0);
+    }
+
+    fclose(pFile);
+  }
+
+  free(g_tUart.pSamples);
+  g_tUart.pSamples   = 0;
+  g_tUart.uiSamples  = 0;
+  g_tUart.uiCapacity = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_baudrate()                                                        */
+/*----------------------------------------------------------------------------*/
+int hostuart_baudrate(uint32_t uiBaudrate)
+{
+  struct termios tTio;
+  speed_t tSpeed;
+
+  switch (uiBaudrate)
+  {
+    case 9600:    tSpeed = B9600;    break;
+    case 19200:   tSpeed = B19200;   break;
+    case 38400:   tSpeed = B38400;   break;
+    case 57600:   tSpeed = B57600;   break;
+    case 115200:  tSpeed = B115200;  break;
+    case 230400:  tSpeed = B230400;  break;
+    case 460800:  tSpeed = B460800;  break;
+    case 921600:  tSpeed = B921600;  break;
+    case 1152000: tSpeed = B1152000; break;
+    case 2000000: tSpeed = B2000000; break;
+    default:      return EINVAL;
+  }
+
+  if ((0 > g_tUart.iFd) || (0 != tcgetattr(g_tUart.iFd, &tTio)))
+  {
+    return ENOTSUP;
+  }
+
+  cfsetspeed(&tTio, tSpeed);
+
+  return (0 == tcsetattr(g_tUart.iFd, TCSADRAIN, &tTio)) ? EOK : ENOTSUP;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_write()                                                           */
+/*----------------------------------------------------------------------------*/
+int hostuart_write(const void* pData, size_t uiSize)
+{
+  const uint8_t* pcData = (const uint8_t*) pData;
+
+  if (0 > g_tUart.iFd)
+  {
+    return ENOTSUP;
+  }
+
+  if (uiSize && !g_tUart.bTxPending && !g_tUart.bArmed)
+  {
+    memset(&g_tUart.tCurrent, 0, sizeof(g_tUart.tCurrent));
+    g_tUart.tCurrent.uiTx = hostuart_micros();
+    g_tUart.bTxPending = true;
+  }
+
+  while (uiSize)
+  {
+    ssize_t iWritten = write(g_tUart.iFd, pcData, uiSize);
+
+    if (0 > iWritten)
+    {
+      if (EINTR == errno)
+      {
+        continue;
+      }
+
+      return ENOTSUP;
+    }
+
+    pcData += iWritten;
+    uiSize -= (size_t) iWritten;
+  }
+
+  if (g_tUart.bTxPending && ('\n' == pcData[-1]))
+  {
+    g_tUart.bTxPending = false;
+    g_tUart.bArmed     = true;
+    g_tUart.uiLineLen  = 0;
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_fill()                                                            */
+/*----------------------------------------------------------------------------*/
+static bool hostuart_fill(int iTimeout)
+{
+  struct pollfd tPoll = { .fd = g_tUart.iFd, .events = POLLIN };
+  ssize_t iRead;
+
+  if (0 > g_tUart.iFd)
+  {
+    return false;
+  }
+
+  if (0 >= poll(&tPoll, 1, iTimeout))
+  {
+    return false;
+  }
+
+  if (0 >= (iRead = read(g_tUart.iFd, g_tUart.acRx, sizeof(g_tUart.acRx))))
+  {
+    return false;
+  }
+
+  g_tUart.uiRxPos  = 0;
+  g_tUart.uiRxFill = (size_t) iRead;
+
+  return true;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_isline()                                                          */
+/*----------------------------------------------------------------------------*/
+static bool hostuart_isline(const char* acText)
+{
+  size_t uiLen = strlen(acText);
+  return (uiLen == g_tUart.uiLineLen) && (0 == memcmp(g_tUart.acLine, acText, uiLen));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_measure()                                                         */
+/*----------------------------------------------------------------------------*/
+static void hostuart_measure(uint8_t uiByte)
+{
+  hostsample_t* pSample = &g_tUart.tCurrent;
+
+  if (!g_tUart.bArmed)
+  {
+    return;
+  }
+
+  if (0 == pSample->uiBytes++)
+  {
+    pSample->uiFirst = hostuart_micros();
+  }
+
+  if ('\r' == uiByte)
+  {
+    return;
+  }
+
+  if ('\n' != uiByte)
+  {
+    if (g_tUart.uiLineLen < sizeof(g_tUart.acLine))
+    {
+      g_tUart.acLine[g_tUart.uiLineLen] = (char) uiByte;
+    }
+
+    ++g_tUart.uiLineLen;
+    return;
+  }
+
+  if (hostuart_isline("OK") || hostuart_isline("SEND OK"))
+  {
+    pSample->bOk = true;
+  }
+  else if (!hostuart_isline("ERROR") && !hostuart_isline("FAIL"))
+  {
+    g_tUart.uiLineLen = 0;
+    return;
+  }
+
+  pSample->uiFinal  = hostuart_micros();
+  g_tUart.uiLineLen = 0;
+  g_tUart.bArmed    = false;
+
+  if (g_tUart.uiSamples == g_tUart.uiCapacity)
+  {
+    size_t uiCapacity = g_tUart.uiCapacity ? 2 * g_tUart.uiCapacity : 256;
+    hostsample_t* pNew = realloc(g_tUart.pSamples, uiCapacity * sizeof(hostsample_t));
+
+    if (!pNew)
+    {
+      return;
+    }
+
+    g_tUart.pSamples   = pNew;
+    g_tUart.uiCapacity = uiCapacity;
+  }
+
+  g_tUart.pSamples[g_tUart.uiSamples++] = *pSample;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_avail()                                                           */
+/*----------------------------------------------------------------------------*/
+size_t hostuart_avail(void)
+{
+  if (g_tUart.uiRxPos >= g_tUart.uiRxFill)
+  {
+    hostuart_fill(0);
+  }
+
+  return g_tUart.uiRxFill - g_tUart.uiRxPos;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* hostuart_getc()                                                            */
+/*----------------------------------------------------------------------------*/
+int hostuart_getc(uint16_t uiTimeout)
+{
+  uint8_t uiByte;
+
+  if (g_tUart.uiRxPos >= g_tUart.uiRxFill)
+  {
+    if (!hostuart_fill((int) uiTimeout))
+    {
+      return -1;
+    }
+  }
+
+  uiByte = g_tUart.acRx[g_tUart.uiRxPos++];
+  hostuart_measure(uiByte);
+
+  return (int) uiByte;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,132 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: hostzxn.c                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: replacement of "libzxn" and z88dk specific library functions     |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <arch/zxn.h>
+
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Simulated CPU speed
+*/
+static uint8_t g_uiSpeed = RTM_3MHZ;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* zxn_getspeed()                                                             */
+/*----------------------------------------------------------------------------*/
+uint8_t zxn_getspeed(void)
+{
+  return g_uiSpeed;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* zxn_setspeed()                                                             */
+/*----------------------------------------------------------------------------*/
+void zxn_setspeed(uint8_t uiSpeed)
+{
+  g_uiSpeed = uiSpeed;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* zxn_rtrim()                                                                */
+/*----------------------------------------------------------------------------*/
+char_t* zxn_rtrim(char_t* acStr)
+{
+  size_t uiLen = strlen(acStr);
+
+  while (uiLen && isspace((unsigned char) acStr[uiLen - 1]))
+  {
+    acStr[--uiLen] = '\0';
+  }
+
+  return acStr;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* zxn_strerror()                                                             */
+/*----------------------------------------------------------------------------*/
+int zxn_strerror(int iCode)
+{
+  const char* acMsg;
+
+  switch (iCode)
+  {
+    case EOK:      acMsg = "no error";      break;
+    case ESTAT:    acMsg = "bad state";     break;
+    case ERANGE:   acMsg = "out of range";  break;
+    case ETIMEOUT: acMsg = "timeout error"; break;
+    case EINVAL:   acMsg = "invalid value"; break;
+    default:       acMsg = strerror(iCode); break;
+  }
+
+  fprintf(stderr, "%s\n", acMsg);
+
+  return iCode;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* strupr()                                                                   */
+/*----------------------------------------------------------------------------*/
+char* strupr(char* pcStr)
+{
+  for (char* pc = pcStr; *pc; ++pc)
+  {
+    *pc = (char) toupper((unsigned char) *pc);
+  }
+
+  return pcStr;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,586 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: esptest.c                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/17/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Host build: unit tests of the hardware independent modules (espio, esptok,   |
+| outq, espmatch, espkv, espfmt)                                               |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/17/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libzxn.h"
+#include "espio.h"
+#include "esptok.h"
+#include "outq.h"
+#include "espmatch.h"
+#include "espkv.h"
+#include "espfmt.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Check a condition; failures are counted and printed with the line
+*/
+#define TEST_CHECK(bCond) testCheck((bCond), #bCond, __LINE__)
+
+/*!
+Size of the buffer of the sinks
+*/
+#define uiTEST_BUFFER (0x800)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Number of checks and failed checks
+*/
+static unsigned g_uiChecks;
+static unsigned g_uiFailed;
+
+/*!
+Output of the sinks (esptok, espkv)
+*/
+static char   g_acSink[uiTEST_BUFFER];
+static size_t g_uiSink;
+
+/*!
+Data of the receive source (espio) and the number of bytes left
+*/
+static char     g_acSource[uiTEST_BUFFER];
+static uint16_t g_uiSourcePos;
+static uint16_t g_uiSourceLen;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* testCheck()                                                                */
+/*----------------------------------------------------------------------------*/
+static void testCheck(bool bCond, const char* acCond, int iLine)
+{
+  ++g_uiChecks;
+
+  if (!bCond)
+  {
+    ++g_uiFailed;
+    fprintf(stderr, "esptest.c:%d: failed: %s\n", iLine, acCond);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sinkClear()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sinkClear(void)
+{
+  g_uiSink = 0;
+  g_acSink[0] = '\0';
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sinkAppend()                                                               */
+/*----------------------------------------------------------------------------*/
+static void sinkAppend(const char_t* pcData, uint16_t uiLen)
+{
+  if (uiLen > (sizeof(g_acSink) - 1 - g_uiSink))
+  {
+    uiLen = (uint16_t) (sizeof(g_acSink) - 1 - g_uiSink);
+  }
+
+  memcpy(&g_acSink[g_uiSink], pcData, uiLen);
+  g_uiSink += uiLen;
+  g_acSink[g_uiSink] = '\0';
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* tokSink()                                                                  */
+/*----------------------------------------------------------------------------*/
+static void tokSink(const char_t* pcData, uint16_t uiLen, bool bFirst)
+{
+  (void) bFirst;
+  sinkAppend(pcData, uiLen);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* kvSink()                                                                   */
+/*----------------------------------------------------------------------------*/
+static void kvSink(const char_t* pcData, uint16_t uiLen, void* pContext)
+{
+  (void) pContext;
+  sinkAppend(pcData, uiLen);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testSource()                                                               */
+/*----------------------------------------------------------------------------*/
+static uint16_t testSource(uint8_t* pDst, uint16_t uiSize)
+{
+  uint16_t uiCount = g_uiSourceLen - g_uiSourcePos;
+
+  if (uiCount > uiSize)
+  {
+    uiCount = uiSize;
+  }
+
+  memcpy(pDst, &g_acSource[g_uiSourcePos], uiCount);
+  g_uiSourcePos += uiCount;
+
+  return uiCount;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sourceSet()                                                                */
+/*----------------------------------------------------------------------------*/
+static void sourceSet(uint16_t uiLen, char cFirst)
+{
+  for (uint16_t i = 0; i < uiLen; ++i)
+  {
+    g_acSource[i] = (char) (cFirst + (i % 26));
+  }
+
+  g_uiSourcePos = 0;
+  g_uiSourceLen = uiLen;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testEspio()                                                                */
+/*----------------------------------------------------------------------------*/
+static void testEspio(void)
+{
+  const char_t* pcData;
+  uint16_t uiCount;
+
+  espio_source(testSource);
+  espio_reset();
+
+  /* Empty source */
+  sourceSet(0, 'a');
+  TEST_CHECK(0 == espio_span(&pcData));
+
+  /* More data than the ring: the rest stays in the source */
+  sourceSet(uiESPIO_RX_SIZE + 0x80, 'a');
+  TEST_CHECK(uiESPIO_RX_SIZE == espio_fill());
+  TEST_CHECK((uiESPIO_RX_SIZE + 0x80) - uiESPIO_RX_SIZE == g_uiSourceLen - g_uiSourcePos);
+
+  uiCount = espio_span(&pcData);
+  TEST_CHECK(uiESPIO_RX_SIZE == uiCount);
+  TEST_CHECK('a' == pcData[0]);
+
+  /* Wrap-around: the span ends at the end of the ring */
+  espio_consume(0x180);
+  uiCount = espio_span(&pcData);
+  TEST_CHECK((uiESPIO_RX_SIZE - 0x180) == uiCount);
+  TEST_CHECK((char_t) ('a' + (0x180 % 26)) == pcData[0]);
+
+  espio_consume(uiCount);
+  uiCount = espio_span(&pcData);
+  TEST_CHECK(0x80 == uiCount);
+  TEST_CHECK((char_t) ('a' + (uiESPIO_RX_SIZE % 26)) == pcData[0]);
+
+  espio_consume(uiCount);
+  TEST_CHECK(0 == espio_span(&pcData));
+
+  espio_reset();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* tokLine()                                                                  */
+/*----------------------------------------------------------------------------*/
+/*
+Scan a text in chunks of "uiChunk" bytes; returns the first classification
+*/
+static esptoken_t tokLine(const char* acText, uint16_t uiChunk)
+{
+  esptoken_t eToken = ESPTOK_NONE;
+  esptoken_t eLine;
+  uint16_t uiLen = (uint16_t) strlen(acText);
+  uint16_t uiPos = 0;
+  uint16_t uiEnd;
+
+  sinkClear();
+  esptok_reset(tokSink);
+
+  while (uiPos < uiLen)
+  {
+    uiEnd = ((uiPos + uiChunk) < uiLen) ? (uiPos + uiChunk) : uiLen;
+
+    while (uiPos < uiEnd)
+    {
+      uiPos += esptok_scan(&acText[uiPos], uiEnd - uiPos, &eLine);
+
+      if ((ESPTOK_NONE == eToken) && (ESPTOK_NONE != eLine))
+      {
+        eToken = eLine;
+      }
+    }
+  }
+
+  return eToken;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testEsptok()                                                               */
+/*----------------------------------------------------------------------------*/
+static void testEsptok(void)
+{
+  TEST_CHECK(ESPTOK_OK == tokLine("OK\r\n", 0x10));
+  TEST_CHECK(ESPTOK_OK == tokLine("OK\r\n", 1));
+  TEST_CHECK(ESPTOK_ERROR == tokLine("\r\nERROR\r\n", 0x10));
+  TEST_CHECK(ESPTOK_SEND_OK == tokLine("SEND OK\r\n", 3));
+  TEST_CHECK(ESPTOK_SEND_FAIL == tokLine("SEND FAIL\r\n", 0x10));
+
+  /* Trailing spaces of a final response */
+  TEST_CHECK(ESPTOK_OK == tokLine("OK \r\n", 0x10));
+  TEST_CHECK(ESPTOK_OK == tokLine("OK   \r\n", 1));
+  TEST_CHECK(ESPTOK_FAIL == tokLine("FAIL \r\n", 0x10));
+
+  /* Anything after the text: data with the text and the spaces */
+  TEST_CHECK(ESPTOK_DATA == tokLine("OK x\r\n", 0x10));
+  TEST_CHECK(0 == strcmp("OK x", g_acSink));
+  TEST_CHECK(ESPTOK_DATA == tokLine("OK  x \r\n", 2));
+  TEST_CHECK(0 == strcmp("OK  x", g_acSink));
+  TEST_CHECK(ESPTOK_DATA == tokLine("OKAY\r\n", 0x10));
+  TEST_CHECK(0 == strcmp("OKAY", g_acSink));
+  TEST_CHECK(ESPTOK_DATA == tokLine("SEND x\r\n", 0x10));
+  TEST_CHECK(0 == strcmp("SEND x", g_acSink));
+
+  /* Prefixes: the rest of the line is content */
+  TEST_CHECK(ESPTOK_BUSY == tokLine("busy p...\r\n", 0x10));
+  TEST_CHECK(0 == strcmp("busy p...", g_acSink));
+  TEST_CHECK(ESPTOK_IPD == tokLine("+IPD,4:abcd\r\n", 0x10));
+  TEST_CHECK(ESPTOK_WIFI == tokLine("WIFI GOT IP\r\n", 0x10));
+
+  /* Spaces inside of data lines are kept, trailing spaces are removed */
+  TEST_CHECK(ESPTOK_DATA == tokLine("a  b  \r\n", 1));
+  TEST_CHECK(0 == strcmp("a  b", g_acSink));
+
+  /* Empty lines only */
+  TEST_CHECK(ESPTOK_NONE == tokLine("\r\n\r\n", 0x10));
+
+  /* Data prompt at the beginning of a line */
+  sinkClear();
+  esptok_reset(tokSink);
+  esptok_prompt(true);
+  {
+    esptoken_t eToken;
+    TEST_CHECK(1 == esptok_scan("> ", 2, &eToken));
+    TEST_CHECK(ESPTOK_PROMPT == eToken);
+    TEST_CHECK(esptok_final(eToken));
+  }
+  esptok_prompt(false);
+
+  TEST_CHECK(esptok_final(ESPTOK_OK));
+  TEST_CHECK(!esptok_final(ESPTOK_BUSY));
+  TEST_CHECK(!esptok_final(ESPTOK_DATA));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* outqCapture()                                                              */
+/*----------------------------------------------------------------------------*/
+/*
+Redirect the console ("stdout") to memory (pStream = 0: back to the console)
+*/
+static void outqCapture(FILE** ppStream, char** ppcData, size_t* puiSize)
+{
+  static FILE* pConsole = 0;
+
+  if (0 == *ppStream)
+  {
+    fflush(stdout);
+    pConsole  = stdout;
+    *ppStream = open_memstream(ppcData, puiSize);
+    stdout    = *ppStream;
+  }
+  else
+  {
+    fflush(*ppStream);
+    stdout = pConsole;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testOutq()                                                                 */
+/*----------------------------------------------------------------------------*/
+static void testOutq(void)
+{
+  static char acLong[uiOUTQ_SIZE + 0x100];
+  FILE* pStream = 0;
+  char* pcData  = 0;
+  size_t uiSize = 0;
+
+  memset(acLong, 'x', sizeof(acLong));
+  outqCapture(&pStream, &pcData, &uiSize);
+
+  /* Plain output */
+  outq_put("a\n", 2);
+  TEST_CHECK(2 == outq_count());
+
+  /* Held line: not rendered before its release */
+  outq_hold();
+  outq_put("b\n", 2);
+  TEST_CHECK(2 == outq_count());
+  TEST_CHECK(outq_release(true));
+  TEST_CHECK(4 == outq_count());
+
+  /* Rejected line */
+  outq_hold();
+  outq_put("c\n", 2);
+  TEST_CHECK(!outq_release(false));
+  TEST_CHECK(4 == outq_count());
+
+  /* Line longer than the queue: dropped, also the rest of it */
+  outq_hold();
+  outq_put(acLong, sizeof(acLong));
+  outq_put("tail\n", 5);
+  TEST_CHECK(!outq_release(true));
+
+  /* The next line is not affected */
+  outq_hold();
+  outq_put("d\n", 2);
+  TEST_CHECK(outq_release(true));
+
+  outq_flush();
+  TEST_CHECK(0 == outq_count());
+
+  outqCapture(&pStream, &pcData, &uiSize);
+  TEST_CHECK((6 == uiSize) && (0 == memcmp("a\nb\nd\n", pcData, 6)));
+
+  fclose(pStream);
+  free(pcData);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* matchLine()                                                                */
+/*----------------------------------------------------------------------------*/
+static uint8_t matchLine(const char* acText, uint16_t uiChunk)
+{
+  uint16_t uiLen = (uint16_t) strlen(acText);
+  uint16_t uiPos = 0;
+  uint8_t uiTags = 0;
+
+  espmatch_line();
+
+  while (uiPos < uiLen)
+  {
+    uint16_t uiCount = ((uiLen - uiPos) < uiChunk) ? (uiLen - uiPos) : uiChunk;
+
+    uiTags = espmatch_feed(&acText[uiPos], uiCount);
+    uiPos += uiCount;
+  }
+
+  return uiTags;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testEspmatch()                                                             */
+/*----------------------------------------------------------------------------*/
+static void testEspmatch(void)
+{
+  espmatch_reset();
+  TEST_CHECK(0 == espmatch_count());
+
+  /* Limits */
+  TEST_CHECK(ERANGE == espmatch_add("", 1));
+  TEST_CHECK(ERANGE == espmatch_add("0123456789abcdefg", 1));
+  TEST_CHECK(EOK == espmatch_add("0123456789abcdef", 1));
+
+  espmatch_reset();
+  TEST_CHECK(EOK == espmatch_add("GOT IP", 0x01));
+  TEST_CHECK(EOK == espmatch_add("a?c", 0x02));
+  TEST_CHECK(EOK == espmatch_add("aab", 0x04));
+  TEST_CHECK(EOK == espmatch_add("x", 0x08));
+  TEST_CHECK(EOK == espmatch_add("y", 0x08));
+  TEST_CHECK(EOK == espmatch_add("z", 0x10));
+  TEST_CHECK(ERANGE == espmatch_add("w", 0x20));
+  TEST_CHECK(6 == espmatch_count());
+
+  /* Anywhere in the line, across chunks */
+  TEST_CHECK(0x01 == matchLine("WIFI GOT IP", 0x20));
+  TEST_CHECK(0x01 == matchLine("WIFI GOT IP", 1));
+  TEST_CHECK(0x00 == matchLine("WIFI GOT I", 0x20));
+
+  /* "?" matches any character, but exactly one */
+  TEST_CHECK(0x02 == matchLine("abc", 0x20));
+  TEST_CHECK(0x02 == matchLine("--a-c--", 2));
+  TEST_CHECK(0x00 == matchLine("ac", 0x20));
+
+  /* Overlapping prefixes */
+  TEST_CHECK(0x04 == matchLine("aaab", 0x20));
+
+  /* Shared tags, several tags in one line */
+  TEST_CHECK(0x08 == matchLine("y", 0x20));
+  TEST_CHECK(0x18 == matchLine("xyz", 1));
+
+  /* A new line starts without tags */
+  TEST_CHECK(0x00 == matchLine("nothing", 0x20));
+
+  espmatch_reset();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* kvLine()                                                                   */
+/*----------------------------------------------------------------------------*/
+static void kvLine(const char* acText, uint16_t uiChunk)
+{
+  uint16_t uiLen = (uint16_t) strlen(acText);
+  uint16_t uiPos = 0;
+
+  espkv_line();
+
+  while (uiPos < uiLen)
+  {
+    uint16_t uiCount = ((uiLen - uiPos) < uiChunk) ? (uiLen - uiPos) : uiChunk;
+
+    espkv_feed(&acText[uiPos], uiCount);
+    uiPos += uiCount;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testEspkv()                                                                */
+/*----------------------------------------------------------------------------*/
+static void testEspkv(void)
+{
+  espkv_open(0, 0);
+  TEST_CHECK(!espkv_active());
+
+  espkv_open(kvSink, 0);
+  TEST_CHECK(espkv_active());
+
+  /* Quotes are removed */
+  sinkClear();
+  kvLine("+CIFSR:STAIP,\"192.168.1.2\"", 0x40);
+  espkv_line();
+  TEST_CHECK(0 == strcmp("IP=192.168.1.2\r", g_acSink));
+
+  /* Commas inside of quotes belong to the field; chunks of one byte */
+  sinkClear();
+  kvLine("+CWJAP:\"my,ssid\",\"aa:bb\",6,-50", 1);
+  espkv_line();
+  TEST_CHECK(0 == strcmp("SSID=my,ssid\rBSSID=aa:bb\rCHANNEL=6\rRSSI=-50\r", g_acSink));
+
+  /* Empty fields are skipped, fields without a key are ignored */
+  sinkClear();
+  kvLine("+CWJAP:,\"b\",1,2,3,4", 0x40);
+  espkv_line();
+  TEST_CHECK(0 == strcmp("BSSID=b\rCHANNEL=1\rRSSI=2\r", g_acSink));
+
+  /* Responses without records */
+  sinkClear();
+  kvLine("+CWLAP:(3,\"x\",-50)", 0x40);
+  kvLine("0123456789abcdefghij", 0x40);
+  espkv_line();
+  TEST_CHECK(0 == g_uiSink);
+
+  espkv_open(0, 0);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* testEspfmt()                                                               */
+/*----------------------------------------------------------------------------*/
+static void testEspfmt(void)
+{
+  char_t acBuffer[0x20];
+
+  TEST_CHECK(1 == espfmt_u32(acBuffer, 0));
+  TEST_CHECK('0' == acBuffer[0]);
+  TEST_CHECK(10 == espfmt_u32(acBuffer, 4294967295UL));
+  TEST_CHECK(0 == memcmp("4294967295", acBuffer, 10));
+
+  TEST_CHECK(12 == espfmt_format(acBuffer, sizeof(acBuffer), "%s:%u,%c%%", "host", 8080u, 'x'));
+  TEST_CHECK(0 == strcmp("host:8080,x%", acBuffer));
+
+  TEST_CHECK(0 < espfmt_format(acBuffer, sizeof(acBuffer), "%d %05u %3u %02u", -42, 7u, 12345u, 3u));
+  TEST_CHECK(0 == strcmp("-42 00007 12345 03", acBuffer));
+
+  TEST_CHECK(0 < espfmt_format(acBuffer, sizeof(acBuffer), "%lu", 123456789UL));
+  TEST_CHECK(0 == strcmp("123456789", acBuffer));
+
+  /* Truncation: always terminated */
+  TEST_CHECK(7 == espfmt_format(acBuffer, 8, "hello %s", "world"));
+  TEST_CHECK(0 == strcmp("hello w", acBuffer));
+  TEST_CHECK(3 == espfmt_format(acBuffer, 4, "%u", 123456u));
+  TEST_CHECK(0 == strcmp("123", acBuffer));
+  TEST_CHECK(0 == espfmt_format(acBuffer, 1, "abc"));
+  TEST_CHECK('\0' == acBuffer[0]);
+
+  acBuffer[0] = 'x';
+  TEST_CHECK(0 == espfmt_format(acBuffer, 0, "abc"));
+  TEST_CHECK('x' == acBuffer[0]);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* main()                                                                     */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+  testEspio();
+  testEsptok();
+  testOutq();
+  testEspmatch();
+  testEspkv();
+  testEspfmt();
+
+  printf("esptest: %u checks, %u failed\n", g_uiChecks, g_uiFailed);
+
+  return g_uiFailed ? 1 : 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
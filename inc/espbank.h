@@ -0,0 +1,116 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espbank.h                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Capture of large responses in 8K pages of memory (NextOS, MMU); ring         |
+| buffer that keeps the latest data, processed after the reception             |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPBANK_H__)
+  #define __ESPBANK_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Maximum number of pages (8K each) of the capture buffer
+*/
+#define uiESPBANK_MAX_PAGES (8)
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Allocate the pages of the capture buffer from NextOS
+@param uiPages Number of pages (1 ... uiESPBANK_MAX_PAGES)
+@return Errorcode (EOK = no error; ENOMEM = not enough memory, nothing
+allocated; EINVAL = invalid number of pages)
+*/
+int espbank_open(uint8_t uiPages);
+
+/*!
+Release all pages of the capture buffer
+*/
+void espbank_close(void);
+
+/*!
+Number of allocated pages
+@return Number of pages (0 = no capture buffer)
+*/
+uint8_t espbank_pages(void);
+
+/*!
+Remove all data from the capture buffer
+*/
+void espbank_reset(void);
+
+/*!
+Append data to the capture buffer; if the buffer is full, the oldest data is
+overwritten
+@param pcData Data
+@param uiLen Number of bytes
+*/
+void espbank_write(const char_t* pcData, uint16_t uiLen);
+
+/*!
+Number of bytes in the capture buffer
+@return Number of bytes
+*/
+uint32_t espbank_count(void);
+
+/*!
+Number of bytes overwritten since "espbank_reset"
+@return Number of bytes
+*/
+uint32_t espbank_lost(void);
+
+/*!
+Map the captured data at a position; the data is accessible until
+"espbank_unmap" (see "espuart_map")
+@param uiPos Position (0 = oldest byte in the buffer)
+@param ppcData Address of the data
+@return Number of contiguous bytes (0 = end of the data)
+*/
+uint16_t espbank_map(uint32_t uiPos, const char_t** ppcData);
+
+/*!
+End the access to the data mapped by "espbank_map"
+*/
+void espbank_unmap(void);
+
+#endif /* __ESPBANK_H__ */
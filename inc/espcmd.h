@@ -49,6 +49,110 @@ Maximum length of a AT command to ESP8266
 */
 #define uiMAX_LEN_CMD (0x80)
 
+/*!
+File to cache the verified state of the ESP8266 link between invocations
+*/
+#define acLINK_STATE_FILE "/tmp/espcmd.sta"
+
+/*!
+Identification of a valid link state record ("ES")
+*/
+#define uiLINK_STATE_MAGIC (0x5345)
+
+/*!
+Time, a cached link state is valid after the last successful sync [s]
+*/
+#define uiLINK_STATE_VALID (30)
+
+/*!
+Maximum length of the firmware version in the link state record
+*/
+#define uiMAX_LEN_FIRMWARE (0x20)
+
+/*!
+Number of entries of the built-in timeout table ("g_atTimeouts")
+*/
+#define uiTIMEOUT_ENTRIES (10)
+
+/*!
+Maximum number of entries of the timeout file ("acTIMEOUT_FILE")
+*/
+#define uiMAX_USER_TIMEOUTS (4)
+
+/*!
+Maximum length of a command prefix of the timeout file
+*/
+#define uiMAX_LEN_PREFIX (0x10)
+
+/*!
+File with timeouts of command prefixes ("prefix ms" per line)
+*/
+#define acTIMEOUT_FILE "/sys/espcmd.tmo"
+
+/*!
+Tags of the patterns that end a command early with success ("-w") or
+failure ("-x")
+*/
+#define uiEXPECT_SUCCESS (1)
+#define uiEXPECT_FAILURE (2)
+
+/*!
+Tags of the patterns that select the printed lines ("-g" shows, "-G" hides)
+*/
+#define uiFILTER_INCLUDE (4)
+#define uiFILTER_EXCLUDE (8)
+
+/*!
+Size of the blocks of file transfers ("-u", "-d") and of the raw copy ("-o")
+*/
+#define uiXFER_BLOCK (0x100)
+
+/*!
+Maximum number of bytes of one "AT+CIPSEND"
+*/
+#define uiXFER_CHUNK (0x800)
+
+/*!
+Size of the command history of the interactive mode ("-i"); the oldest
+commands are dropped
+*/
+#define uiHISTORY_SIZE (0x80)
+
+/*!
+Size of the read buffer of script files ("-f") and the timeout file
+*/
+#define uiBATCH_BLOCK (0x40)
+
+/*!
+Identification at the begin of a transcript ("-R")
+*/
+#define acTRANSCRIPT_MAGIC "ESPT"
+
+/*!
+Types of the records of a transcript: command sent, data received
+*/
+#define uiTRANSCRIPT_CMD ('C')
+#define uiTRANSCRIPT_RX  ('R')
+
+/*!
+Size of the header of a record: type, time since the previous record [ms]
+and length of the data (both 16 bit, little endian)
+*/
+#define uiTRANSCRIPT_HEADER (5)
+
+/*!
+Size of the buffer of the exported records ("-e"); written to the file or the
+memory when full and after each command
+*/
+#define uiEXPORT_BLOCK (0x40)
+
+/*!
+Memory of BASIC that accepts exported records ("-e @n"): above RAMTOP, below
+the IM2 vector table; at most "uiEXPORT_MAX_SIZE" bytes
+*/
+#define uiEXPORT_END_ADDRESS (0xFD00)
+#define uiEXPORT_MAX_SIZE    (0x1000)
+
 /*============================================================================*/
 /*                               Namespaces                                   */
 /*============================================================================*/
@@ -69,16 +173,104 @@ Maximum length of a AT command to ESP8266
 /*                               Typ-Definitionen                             */
 /*============================================================================*/
 /*!
-Enumeration/list of all actions the application can execute
+Enumeration/list of all actions the application can execute; the actions
+from ACTION_COMMAND on talk to the ESP8266
 */
 typedef enum _action
 {
   ACTION_NONE = 0,
   ACTION_HELP,
   ACTION_INFO,
-  ACTION_COMMAND
+  ACTION_COMMAND,
+  ACTION_BATCH,
+  ACTION_UPLOAD,
+  ACTION_DOWNLOAD,
+  ACTION_INTERACTIVE,
+  ACTION_REPLAY
 } action_t;
 
+/*!
+Timeout budget read from the timeout file ("acTIMEOUT_FILE")
+*/
+typedef struct _usertimeout
+{
+  /*!
+  Prefix of the commands
+  */
+  char_t acPrefix[uiMAX_LEN_PREFIX];
+
+  /*!
+  Timeout [ms]
+  */
+  uint16_t uiTimeout;
+} usertimeout_t;
+
+/*!
+State of the ESP8266 link that is cached between invocations (file)
+*/
+typedef struct _linkstate
+{
+  /*!
+  Identification of a valid record (uiLINK_STATE_MAGIC)
+  */
+  uint16_t uiMagic;
+
+  /*!
+  Baudrate of the ESP8266 and the UART [bit/s]
+  */
+  uint32_t uiBaudrate;
+
+  /*!
+  Time of the last successful sync with the ESP8266 [s]
+  */
+  uint16_t uiSync;
+
+  /*!
+  Firmware version of the ESP8266 ("AT version:...")
+  */
+  char_t acFirmware[uiMAX_LEN_FIRMWARE];
+
+  /*!
+  Learned response times of the entries of the timeout table; the last entry
+  is used for all other commands (longest gap without data [ms])
+  */
+  uint16_t auiLearned[uiTIMEOUT_ENTRIES + 1];
+
+  /*!
+  Time stamp (MS-DOS format) and size of the timeout file the entries were
+  read from; the file is only parsed again if one of them changed
+  */
+  uint16_t uiUserTime;
+  uint16_t uiUserDate;
+  uint32_t uiUserSize;
+
+  /*!
+  Number of entries read from the timeout file
+  */
+  uint8_t uiUser;
+
+  /*!
+  Entries read from the timeout file; used before the built-in table
+  */
+  usertimeout_t atUser[uiMAX_USER_TIMEOUTS];
+} linkstate_t;
+
+/*!
+Timeout budget of all commands starting with a prefix
+*/
+typedef struct _timeout
+{
+  /*!
+  Prefix of the commands (e.g. "AT+CWJAP")
+  */
+  const char_t* acPrefix;
+
+  /*!
+  Timeout [ms]
+  */
+  uint16_t uiTimeout;
+} timeout_t;
+
 /*!
 In dieser Struktur werden alle globalen Daten der Anwendung gespeichert.
 */
@@ -104,16 +296,242 @@ typedef struct _appstate
   */
   uint32_t uiBaudrate;
 
+  /*!
+  If this flag is set, the baudrate of the ESP8266 is detected ("-b auto");
+  "uiBaudrate" is the first candidate
+  */
+  bool bAutoBaud;
+
+  /*!
+  If this flag is set, the baudrate is raised to the highest possible rate
+  for the session ("turbo")
+  */
+  bool bTurbo;
+
+  /*!
+  If this flag is set, the hardware flow control (RTS/CTS) of the ESP8266 and
+  the UART is enabled for the session ("-F")
+  */
+  bool bFlow;
+
+  /*!
+  Flow control of the session is active (0 = not requested or not available)
+  */
+  bool bFlowActive;
+
+  /*!
+  Negotiated "turbo" baudrate of the session (0 = not active)
+  */
+  uint32_t uiTurboBaudrate;
+
+  /*!
+  If this flag is set, received data is moved from the UART to the receive
+  buffer by an interrupt ("-I")
+  */
+  bool bIrq;
+
+  /*!
+  Number of 8K pages of memory to capture responses in ("-M"); 0 = responses
+  are processed while they are received
+  */
+  uint8_t uiPages;
+
   /*!
   Timeout used for communication with ESP8266 (default: ~2000 ms)
   */
   uint16_t uiTimeout;
 
+  struct
+  {
+    /*!
+    Maximum number of retries of a command after "busy" or a timeout ("-r")
+    */
+    uint8_t uiMax;
+
+    /*!
+    Number of retries of the last command
+    */
+    uint8_t uiUsed;
+  } retry;
+
+  struct
+  {
+    /*!
+    If this flag is set, only lines with an include pattern are shown ("-g")
+    */
+    bool bInclude;
+
+    /*!
+    If this flag is set, lines with an exclude pattern are hidden ("-G")
+    */
+    bool bExclude;
+
+    /*!
+    Maximum number of lines shown per command ("-n"; 0 = no limit)
+    */
+    uint16_t uiMax;
+
+    /*!
+    Number of lines shown of the current command
+    */
+    uint16_t uiLines;
+
+    /*!
+    If this flag is set, the current line is held in the output queue until
+    its end decides whether it is shown
+    */
+    bool bHeld;
+  } filter;
+
+  struct
+  {
+    /*!
+    If this flag is set, "uiTimeout" is used for all commands ("-t")
+    */
+    bool bFixed;
+  } timeout;
+
+  /*!
+  Command to execute (argument of the command line); 0 = none
+  */
+  const char_t* pcCmd;
+
   /*!
-  Name of the host to ping
+  Buffer for the lines of a script and for commands built by the application
   */
   char_t acCmd[uiMAX_LEN_CMD];
 
+  /*!
+  Name of the script file to execute in batch mode ("-f"); 0 = none
+  */
+  const char_t* pcFile;
+
+  /*!
+  If this flag is set, a script continues with the next line after errors
+  */
+  bool bContinue;
+
+  /*!
+  If this flag is set, the commands are read from the keyboard ("-i")
+  */
+  bool bInteractive;
+
+  /*!
+  Name of the file to upload ("-u") or download ("-d"); 0 = none
+  */
+  const char_t* pcXferFile;
+
+  /*!
+  Name of the file for a raw copy of the responses ("-o"); the blocks of the
+  transfers ("xfer") buffer the data; 0 = none
+  */
+  const char_t* pcRawFile;
+
+  /*!
+  If this flag is set, the raw copy is appended to "pcRawFile" ("-a")
+  */
+  bool bAppend;
+
+  struct
+  {
+    /*!
+    File for the records of the extracted fields ("-e"); 0 = none
+    */
+    const char_t* pcFile;
+
+    /*!
+    Address in the memory of BASIC for the records ("-e @n"; ends with a
+    NUL); 0 = file
+    */
+    uint16_t uiAddress;
+
+    /*!
+    End of the memory of the records (exclusive; NUL included)
+    */
+    uint16_t uiEnd;
+
+    /*!
+    If this flag is set, the file was created by a previous command
+    */
+    bool bStarted;
+
+    /*!
+    Number of bytes in the buffer
+    */
+    uint8_t uiFill;
+
+    /*!
+    Buffer of the records
+    */
+    char_t acBuffer[uiEXPORT_BLOCK];
+  } export;
+
+  struct
+  {
+    /*!
+    If this flag is set, "pcRawFile" is a transcript with commands and time
+    stamps ("-R"), otherwise a raw copy ("-o")
+    */
+    bool bRecord;
+
+    /*!
+    Transcript to replay instead of the UART ("-P"); 0 = none
+    */
+    const char_t* pcFile;
+
+    /*!
+    If this flag is set, a transcript is replayed without the recorded
+    delays ("-z")
+    */
+    bool bFast;
+
+    /*!
+    Header of the next record ("uiTRANSCRIPT_HEADER" bytes)
+    */
+    uint8_t acHeader[uiTRANSCRIPT_HEADER];
+
+    /*!
+    Replay: the header of the next record was read, its data not
+    */
+    bool bHeader;
+
+    /*!
+    Replay: the data of the response ends (next command or end of file)
+    */
+    bool bEnd;
+
+    /*!
+    Replay: number of bytes of the current record that are not delivered
+    */
+    uint16_t uiLeft;
+
+    /*!
+    Time of the last record [ms]
+    */
+    uint16_t uiClock;
+  } transcript;
+
+  /*!
+  Path of the HTTP request of a download ("-p"); 0 = raw TCP stream
+  */
+  const char_t* pcPath;
+
+  /*!
+  If this flag is set, "pcXferFile" is downloaded ("-d"), otherwise uploaded
+  */
+  bool bDownload;
+
+  /*!
+  Name/address of the TCP server of transfers ("-s host:port"); the port is
+  cut off in the argument of the command line; 0 = none
+  */
+  char_t* pcServer;
+
+  /*!
+  TCP port of the server
+  */
+  uint16_t uiPort;
+
   /*!
   Backup: Current speed of Z80N
   */
@@ -127,16 +545,275 @@ typedef struct _appstate
   struct
   {
     /*!
-    Buffer for response from ESP8266
+    If this flag is set, received data is not printed (internal requests)
+    */
+    bool bSilent;
+
+    /*!
+    Tag of the pattern that matched the current line (0 = no match)
+    */
+    uint8_t uiMatch;
+
+    /*!
+    Tags of all patterns that matched the current line (incl. filters)
+    */
+    uint8_t uiTags;
+
+    /*!
+    Number of received characters of the current line that match the echo of
+    the sync probe ("AT"; 0xFF = other line)
+    */
+    uint8_t uiEcho;
+
+    /*!
+    If this flag is set, the last command ended early on a pattern and its
+    final response is still outstanding
+    */
+    bool bOutstanding;
+
+    /*!
+    If this flag is set, the ESP8266 rejected the command ("busy p...")
+    */
+    bool bBusy;
+
+    /*!
+    If this flag is set, the response is captured in the pages of memory and
+    processed after the final response ("-M")
+    */
+    bool bBanked;
+
+    /*!
+    Longest gap without received data of the current response [ms]
+    */
+    uint16_t uiGap;
+
+    /*!
+    Buffer to capture the rest of the first received line starting with
+    "acCapture" (internal requests); 0 = no capture
+    */
+    char_t* pcCapture;
+
+    /*!
+    Prefix of the line to capture
+    */
+    const char_t* acCapture;
+
+    /*!
+    Size of the capture buffer
+    */
+    uint8_t uiCaptureSize;
+
+    /*!
+    Position in the current line; 0xFF = the line does not start with the
+    prefix
+    */
+    uint8_t uiCapture;
+  } rx;
+
+  struct
+  {
+    /*!
+    Cached state of the link (see "acLINK_STATE_FILE")
+    */
+    linkstate_t tState;
+
+    /*!
+    If this flag is set, the session uses the cached state (no initialization
+    of the UART/ESP8266)
+    */
+    bool bCached;
+
+    /*!
+    If this flag is set, a final response was received in this session
+    */
+    bool bSynced;
+
+    /*!
+    If this flag is set, the cached state has to be written back
+    */
+    bool bDirty;
+  } link;
+
+  struct
+  {
+    /*!
+    Handle of the opened script file
+    */
+    uint8_t hFile;
+
+    /*!
+    Number of valid bytes in the read buffer
+    */
+    uint8_t uiFill;
+
+    /*!
+    Index of the next unread byte in the read buffer
+    */
+    uint8_t uiPos;
+
+    /*!
+    Read buffer for blockwise reading of the script file
+    */
+    char_t acBuffer[uiBATCH_BLOCK];
+  } batch;
+
+  struct
+  {
+    /*!
+    Number of used bytes of the history
+    */
+    uint16_t uiUsed;
+
+    /*!
+    Number of commands in the history
+    */
+    uint8_t uiCount;
+
+    /*!
+    Command of the history shown in the input line (1 = newest; 0 = none)
+    */
+    uint8_t uiShown;
+
+    /*!
+    Commands (NUL terminated, oldest first)
+    */
+    char_t acHistory[uiHISTORY_SIZE];
+  } repl;
+
+  struct
+  {
+    /*!
+    Handle of the file to transfer or of the raw copy ("-o")
+    */
+    uint8_t hFile;
+
+    /*!
+    Number of valid bytes in the buffer
+    */
+    uint16_t uiFill;
+
+    /*!
+    Index of the next byte to send
+    */
+    uint16_t uiPos;
+
+    /*!
+    Download: index of the block that is filled (0/1)
+    */
+    uint8_t uiBlock;
+
+    /*!
+    Download: the other block is full and waits for a gap in the data stream
+    to be written
+    */
+    bool bPending;
+
+    /*!
+    Upload: the first block is read while the ESP8266 forwards the previous
+    chunk; download: double buffer (one block is written to the file while
+    the other one is filled)
+    */
+    uint8_t acBuffer[2 * uiXFER_BLOCK];
+  } xfer;
+
+  struct
+  {
+    /*!
+    If this flag is set, the HTTP header is received (skipped)
+    */
+    bool bHeader;
+
+    /*!
+    Number of characters in the current line of the header
+    */
+    uint16_t uiLine;
+
+    /*!
+    Number of matched characters of "Content-Length:" (status line: number of
+    spaces)
+    */
+    uint8_t uiMatch;
+
+    /*!
+    If this flag is set, the status line (first line) is complete
+    */
+    bool bStatus;
+
+    /*!
+    Status code of the response
+    */
+    uint16_t uiStatus;
+
+    /*!
+    Length of the body; valid if bLength is set
     */
-    char_t acTxBuffer[uiMAX_LEN_CMD];
+    uint32_t uiLength;
 
     /*!
-    Buffer for response from ESP8266
+    If this flag is set, the header contained "Content-Length"
     */
-    char_t acRxBuffer[uiMAX_LEN_CMD];
-  } esp;
+    bool bLength;
+  } http;
   
+  struct
+  {
+    /*!
+    If this flag is set, the timing of each command is recorded ("-T")
+    */
+    bool bEnabled;
+
+    /*!
+    If this flag is set, the record is printed ("-T"); otherwise it is only
+    appended to the log file
+    */
+    bool bPrint;
+
+    /*!
+    CSV file the records are appended to ("-L"); 0 = no log
+    */
+    const char_t* pcLog;
+
+    /*!
+    Setup of the session: baudrate, timeout, sync, ... [us]
+    */
+    uint32_t uiSetup;
+
+    /*!
+    Time of the transmission of the command
+    */
+    uint32_t uiTx;
+
+    /*!
+    Transmission until the first received byte [us]; 0 = nothing received
+    */
+    uint32_t uiFirst;
+
+    /*!
+    Transmission until the final response [us]
+    */
+    uint32_t uiFinal;
+
+    /*!
+    Time spent on printing [us]
+    */
+    uint32_t uiPrint;
+
+    /*!
+    Number of received lines (including the final response)
+    */
+    uint16_t uiLines;
+
+    /*!
+    Number of received bytes
+    */
+    uint32_t uiBytes;
+
+    /*!
+    Counters of the receive FIFO of the UART (throttled, overruns)
+    */
+    espuart_stats_t tUart;
+  } timing;
+
   /*!
   Exitcode of the application, that is handovered to BASIC
   */
@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espfmt.h                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Small formatters for the output of the application (replacement of the       |
+| printf family: "%s", "%c", "%d", "%u", "%lu" and widths only)                |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPFMT_H__)
+  #define __ESPFMT_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Size of a buffer for the decimal representation of a 32 bit value
+*/
+#define uiESPFMT_MAX_DIGITS (11)
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Receiver of the formatted output
+@param pcData Chunk of the output
+@param uiLen Length of the chunk
+@param pContext Context given to "espfmt_print"
+*/
+typedef void (*espfmt_sink_t)(const char_t* pcData, uint16_t uiLen, void* pContext);
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Decimal representation of an unsigned value
+@param acBuffer Buffer (at least "uiESPFMT_MAX_DIGITS" characters)
+@param uiValue Value
+@return Number of digits
+*/
+uint8_t espfmt_u32(char_t* acBuffer, uint32_t uiValue);
+
+/*!
+Format a string; supported are "%s", "%c", "%d", "%u", "%lu", "%%" and a
+width with optional leading zeros (e.g. "%02u")
+@param pfnSink Receiver of the output
+@param pContext Context given to the receiver
+@param acFmt Format string
+@param tArgs Arguments
+*/
+void espfmt_vprint(espfmt_sink_t pfnSink, void* pContext, const char_t* acFmt, va_list tArgs);
+
+/*!
+Format a string (see "espfmt_vprint")
+@param pfnSink Receiver of the output
+@param pContext Context given to the receiver
+@param acFmt Format string
+*/
+void espfmt_print(espfmt_sink_t pfnSink, void* pContext, const char_t* acFmt, ...);
+
+/*!
+Format a string into a buffer (replacement of "snprintf"); the result is
+truncated to the size of the buffer and always terminated
+@param acBuffer Buffer
+@param uiSize Size of the buffer
+@param acFmt Format string
+@return Length of the result
+*/
+uint16_t espfmt_format(char_t* acBuffer, uint16_t uiSize, const char_t* acFmt, ...);
+
+#endif /* __ESPFMT_H__ */
@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espio.h                                                            |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Receive buffer (ring) of the ESP8266 connection: bytes are moved from the    |
+| UART into the ring and processed in place (no copies per line)               |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPIO_H__)
+  #define __ESPIO_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Size of the receive ring buffer (must be a power of 2)
+*/
+#define uiESPIO_RX_SIZE (0x200)
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Source of received data (default: "espuart_read")
+@param pDst Destination buffer
+@param uiSize Size of the destination buffer
+@return Number of bytes read (0 = no data available)
+*/
+typedef uint16_t (*espio_source_t)(uint8_t* pDst, uint16_t uiSize);
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Discard all data in the receive buffer
+*/
+void espio_reset(void);
+
+/*!
+Switch between polling and interrupt driven reception; with interrupts the
+buffer is also filled while the application is busy (output, files, ...)
+@param bEnable true = interrupt driven, false = polling
+@return Errorcode (EOK = no error)
+*/
+int espio_irq(bool bEnable);
+
+/*!
+Replace the UART as source of received data (e.g. replay of a transcript)
+@param pfnSource Source of the data; 0 = UART
+*/
+void espio_source(espio_source_t pfnSource);
+
+/*!
+Move all available bytes from the UART (or the source) to the receive buffer;
+with interrupt driven reception in a critical section only (see "espio_span")
+@return Number of bytes in the receive buffer
+*/
+uint16_t espio_fill(void);
+
+/*!
+Get the next contiguous block of received data (the block is not consumed)
+@param ppData Pointer to the first byte of the block
+@return Number of bytes in the block (0 = no data available)
+*/
+uint16_t espio_span(const char_t** ppData);
+
+/*!
+Remove processed bytes from the receive buffer
+@param uiCount Number of bytes to remove
+*/
+void espio_consume(uint16_t uiCount);
+
+#endif /* __ESPIO_H__ */
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espkv.h                                                            |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Fields of common responses extracted while the lines are streamed (chunks)   |
+| and passed on as key=value records ("-e")                                    |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPKV_H__)
+  #define __ESPKV_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "libzxn.h"
+#include "espfmt.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Maximum length of the prefix of an exported response (e.g. "+CIFSR:STAIP,")
+*/
+#define uiESPKV_MAX_PREFIX (0x10)
+
+/*!
+End of a record ("KEY=value"); NextBASIC reads records with "INPUT #" or
+"PEEK$(address,~13)"
+*/
+#define cESPKV_END ('\r')
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Set the receiver of the records
+@param pfnSink Receiver (0 = no export)
+@param pContext Context passed to the receiver
+*/
+void espkv_open(espfmt_sink_t pfnSink, void* pContext);
+
+/*!
+Check, if records are exported
+@return true = receiver set
+*/
+bool espkv_active(void);
+
+/*!
+Start a new line; the record of the last field of the previous line is
+completed
+*/
+void espkv_line(void);
+
+/*!
+Extract the fields of the next chunk of the current line; the fields are
+separated by ",", quotes are removed
+@param pcData Chunk of the line
+@param uiLen Length of the chunk
+*/
+void espkv_feed(const char_t* pcData, uint16_t uiLen);
+
+#endif /* __ESPKV_H__ */
@@ -0,0 +1,95 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espmatch.h                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Patterns matched against received lines while they are streamed (chunks);    |
+| used to end commands early ("-w", "-x")                                      |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPMATCH_H__)
+  #define __ESPMATCH_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Maximum number of patterns
+*/
+#define uiESPMATCH_MAX_PATTERNS (6)
+
+/*!
+Maximum length of a pattern (bits of the match state)
+*/
+#define uiESPMATCH_MAX_LEN (16)
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Remove all patterns
+*/
+void espmatch_reset(void);
+
+/*!
+Add a pattern; a pattern matches anywhere in a line, "?" matches any character
+@param acPattern Pattern
+@param uiTag Bit set in the result of "espmatch_feed" on a match (not 0)
+@return Errorcode (EOK = no error; ERANGE = too many/too long)
+*/
+int espmatch_add(const char_t* acPattern, uint8_t uiTag);
+
+/*!
+Check, if patterns are defined
+@return Number of patterns
+*/
+uint8_t espmatch_count(void);
+
+/*!
+Start matching at the beginning of a line
+*/
+void espmatch_line(void);
+
+/*!
+Match the next chunk of the current line
+@param pcData Chunk of the line
+@param uiLen Length of the chunk
+@return Tags of all patterns that matched in the line so far (0 = no match)
+*/
+uint8_t espmatch_feed(const char_t* pcData, uint16_t uiLen);
+
+#endif /* __ESPMATCH_H__ */
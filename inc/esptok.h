@@ -0,0 +1,113 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: esptok.h                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Single-pass scanner of the responses of the ESP8266: finds line boundaries,  |
+| trims and classifies the lines (prefix table) in place in the receive buffer |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPTOK_H__)
+  #define __ESPTOK_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Classification of a received line
+*/
+typedef enum _esptoken
+{
+  ESPTOK_NONE = 0,  /* no complete line (more data required) */
+  ESPTOK_DATA,      /* any other line */
+  ESPTOK_OK,        /* "OK" */
+  ESPTOK_ERROR,     /* "ERROR" */
+  ESPTOK_FAIL,      /* "FAIL" */
+  ESPTOK_SEND_OK,   /* "SEND OK" */
+  ESPTOK_SEND_FAIL, /* "SEND FAIL" */
+  ESPTOK_READY,     /* "ready" (end of reset) */
+  ESPTOK_BUSY,      /* "busy p..."/"busy s..." */
+  ESPTOK_IPD,       /* "+IPD,..." (received network data) */
+  ESPTOK_WIFI,      /* "WIFI ..." (unsolicited state of the connection) */
+  ESPTOK_PROMPT     /* ">" (AT+CIPSEND is ready for data; no end of line) */
+} esptoken_t;
+
+/*!
+Receiver of the content of printable lines (data, "busy", "+IPD", "WIFI");
+the content is passed in one or more chunks, pointing into the scanned data
+@param pcData Chunk of the line (trimmed, without CR/LF)
+@param uiLen Length of the chunk
+@param bFirst true = first chunk of the line
+*/
+typedef void (*esptok_sink_t)(const char_t* pcData, uint16_t uiLen, bool bFirst);
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Start scanning at the beginning of a line
+@param pfnSink Receiver of the content of printable lines (0 = the lines are
+classified only)
+*/
+void esptok_reset(esptok_sink_t pfnSink);
+
+/*!
+Enable the detection of the data prompt of "AT+CIPSEND": a ">" at the
+beginning of a line is returned immediately as ESPTOK_PROMPT
+@param bEnable true = detect prompt
+*/
+void esptok_prompt(bool bEnable);
+
+/*!
+Scan received data up to the end of the next line; empty lines are skipped
+and the lines of final responses are not passed to the sink
+@param pcData Received data
+@param uiCount Number of received bytes
+@param peToken Classification of the completed line (ESPTOK_NONE = the data
+ended inside a line)
+@return Number of processed bytes
+*/
+uint16_t esptok_scan(const char_t* pcData, uint16_t uiCount, esptoken_t* peToken);
+
+/*!
+Check for a final response of a command (including the data prompt)
+@param eToken Classification of a line
+@return true = final response
+*/
+bool esptok_final(esptoken_t eToken);
+
+#endif /* __ESPTOK_H__ */
@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: esptrace.h                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Compact in-memory event trace (build option "__TRACE__"): event, time        |
+| stamp and payload are recorded without formatting and dumped at the end      |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPTRACE_H__)
+  #define __ESPTRACE_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Number of recorded events (power of 2); older events are overwritten
+*/
+#define uiESPTRACE_ENTRIES (64)
+
+/*!
+File of the dump; if it cannot be created, the trace is printed
+*/
+#if !defined(acESPTRACE_FILE)
+  #define acESPTRACE_FILE "/tmp/espcmd.trc"
+#endif
+
+/*!
+Record an event/dump the trace; without "__TRACE__" no code is generated
+*/
+#if defined(__TRACE__)
+  #define ESPTRACE(eEvent, uiData) esptrace_event((eEvent), (uint16_t) (uiData))
+  #define ESPTRACE_DUMP()          esptrace_dump()
+#else
+  #define ESPTRACE(eEvent, uiData)
+  #define ESPTRACE_DUMP()
+#endif
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Events of the trace (the meaning of the payload is given in brackets)
+*/
+typedef enum _esptrace_event
+{
+  ESPTRACE_NONE = 0,
+  ESPTRACE_FILL,    /* bytes moved from the UART to the receive buffer */
+  ESPTRACE_TX,      /* length of the transmitted command */
+  ESPTRACE_LINE,    /* classification of a received line (esptoken_t) */
+  ESPTRACE_RENDER,  /* queued bytes of the output, rendered while idle */
+  ESPTRACE_BLOCK,   /* number of the written block (raw copy, download) */
+  ESPTRACE_TIMEOUT, /* timeout of the response [ms] */
+  ESPTRACE_BUDGET,  /* timeout of the next command [ms] */
+  ESPTRACE_PROBE,   /* sync probe (ms since the start of the sync) */
+  ESPTRACE_BAUD,    /* candidate of the baudrate detection [bit/s / 100] */
+  ESPTRACE_IRQ      /* bytes moved by the receive interrupt since the last fill */
+} esptrace_event_t;
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Record an event (use "ESPTRACE"); not reentrant, must not be called by the
+receive interrupt
+@param eEvent Event
+@param uiData Payload
+*/
+void esptrace_event(esptrace_event_t eEvent, uint16_t uiData);
+
+/*!
+Write the recorded events to "acESPTRACE_FILE" (or the console); one line per
+event: time since the first event [us], event, payload (use "ESPTRACE_DUMP")
+*/
+void esptrace_dump(void);
+
+#endif /* __ESPTRACE_H__ */
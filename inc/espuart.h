@@ -0,0 +1,239 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espuart.h                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Hardware access to the UART of the ZX Spectrum Next (ESP8266)                |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__ESPUART_H__)
+  #define __ESPUART_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Address of the IM2 vector table of the receive interrupt (257 bytes); the ISR
+is entered through a jump at 0xFEFE. The memory has to be reserved from BASIC
+(RAMTOP below this address, e.g. "CLEAR 64767").
+*/
+#define uiESPUART_IM2_TABLE (0xFD00)
+
+/*!
+Highest baudrate of the receive interrupt without flow control: the interrupt
+runs once per frame (50 Hz) and has to empty the FIFO (512 bytes) before it
+overflows (230400 bit/s = 461 bytes per frame)
+*/
+#define uiESPUART_IRQ_MAX_BAUDRATE (230400)
+
+/*!
+Size of a page of memory mapped by "espuart_map" (MMU)
+*/
+#define uiESPUART_PAGE_SIZE (0x2000)
+
+/*!
+Resolution of "espuart_clock" [ms]: one frame (20 ms at 50 Hz, 16.7 ms at
+60 Hz); shorter delays are rounded up to a frame
+*/
+#define uiESPUART_CLOCK_TICK (20)
+
+/*!
+Codes of "espuart_key" besides printable characters
+*/
+#define uiESPUART_KEY_DOWN   (0x0A)
+#define uiESPUART_KEY_UP     (0x0B)
+#define uiESPUART_KEY_DELETE (0x0C)
+#define uiESPUART_KEY_ENTER  (0x0D)
+#define uiESPUART_KEY_END    (0x04)
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Handler, that is called by the receive interrupt
+*/
+typedef void (*espuart_handler_t)(void);
+
+/*!
+Counters of the receive FIFO of the UART (see "espuart_stats")
+*/
+typedef struct _espuart_stats
+{
+  /*!
+  Reads with the FIFO filled above 3/4; with flow control ("espuart_flow") the
+  ESP8266 is throttled (RTS released) at this level
+  */
+  uint16_t uiThrottled;
+
+  /*!
+  Reads after an overflow of the FIFO (received data lost)
+  */
+  uint16_t uiOverruns;
+} espuart_stats_t;
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Move all bytes that are available in the receive FIFO of the UART to a buffer
+@param pDst Destination buffer
+@param uiSize Size of the destination buffer
+@return Number of bytes read (0 = FIFO empty)
+*/
+uint16_t espuart_read(uint8_t* pDst, uint16_t uiSize);
+
+/*!
+Free running millisecond clock used for timeouts and measurements; advances
+once per frame (50 Hz or 60 Hz, NextReg 0x05)
+@return Time [ms] (wraps around after ~65 s)
+*/
+uint16_t espuart_clock(void);
+
+/*!
+Free running seconds clock that continues across invocations of the
+application (until the next reset of the machine)
+@return Time [s]
+*/
+uint16_t espuart_seconds(void);
+
+/*!
+Fine clock for time measurements: "FRAMES" and the raster line (resolution
+64 us at 50 Hz, 63 us at 60 Hz); differences are valid modulo 2^32
+@return Time [us]
+*/
+uint32_t espuart_micros(void);
+
+/*!
+Raw time stamp for traces (no arithmetic); converted by "espuart_ticks_us"
+@return Time stamp (frame counter and raster line)
+*/
+uint32_t espuart_ticks(void);
+
+/*!
+Convert a raw time stamp of "espuart_ticks"; differences are valid modulo
+65536 frames (~21 min)
+@param uiTicks Time stamp
+@return Time [us]
+*/
+uint32_t espuart_ticks_us(uint32_t uiTicks);
+
+/*!
+Read and clear the counters of the receive FIFO
+@param pStats Counters since the last call
+*/
+void espuart_stats(espuart_stats_t* pStats);
+
+/*!
+Enable/disable the hardware flow control (RTS/CTS) of the UART; the ESP8266
+has to be switched by "AT+UART_CUR" as well
+@param bEnable true = flow control on
+*/
+void espuart_flow(bool bEnable);
+
+/*!
+Transmit raw data to the ESP8266 (waits while the transmit FIFO is full)
+@param pSrc Data to send
+@param uiSize Number of bytes
+*/
+void espuart_write(const uint8_t* pSrc, uint16_t uiSize);
+
+/*!
+Install an interrupt (IM2, 50 Hz frame interrupt) that calls a handler to
+move received bytes out of the UART FIFO while the application is busy
+@param pfnHandler Handler to call (interrupts disabled)
+@return Errorcode (EOK = no error; ENOMEM = memory of the vector table is not
+reserved)
+*/
+int espuart_irq_enable(espuart_handler_t pfnHandler);
+
+/*!
+Remove the interrupt installed by "espuart_irq_enable" (back to IM1)
+*/
+void espuart_irq_disable(void);
+
+/*!
+Map a page of memory (8K, allocated from NextOS) into the address space; the
+window is MMU slot 6 (0xC000) or slot 5, if the stack is located in slot 6.
+Until "espuart_unmap" the memory of the window (BASIC) must not be accessed.
+@param uiPage Number of the page
+@return Address of the window
+*/
+uint8_t* espuart_map(uint8_t uiPage);
+
+/*!
+Restore the page of the window that was mapped before "espuart_map"
+*/
+void espuart_unmap(void);
+
+/*!
+Page mapped to the window by "espuart_map"
+@return Number of the page (0xFF = memory of BASIC)
+*/
+uint8_t espuart_mapped(void);
+
+/*!
+Highest address of BASIC (system variable "RAMTOP", set by "CLEAR"); the
+memory above is reserved for machine code
+@return Address
+*/
+uint16_t espuart_ramtop(void);
+
+/*!
+Access to the memory of BASIC (e.g. results for the BASIC program); the
+window of "espuart_map" must not be mapped
+@param uiAddress Address (0x4000..0xFFFF)
+@return Pointer to the memory
+*/
+uint8_t* espuart_memory(uint16_t uiAddress);
+
+/*!
+Read the keyboard without waiting; a key is reported once when it is pressed
+(no auto repeat)
+@return Character/code of the pressed key ("uiESPUART_KEY_..."); 0 = none
+*/
+uint8_t espuart_key(void);
+
+/*!
+Begin of a critical section (no receive interrupt)
+*/
+void espuart_lock(void);
+
+/*!
+End of a critical section
+*/
+void espuart_unlock(void);
+
+#endif /* __ESPUART_H__ */
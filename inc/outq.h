@@ -0,0 +1,104 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: outq.h                                                             |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Output queue: received data is queued and rendered to the console while the  |
+| ESP8266 is idle, so that the reception always has priority                   |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+#if !defined(__OUTQ_H__)
+  #define __OUTQ_H__
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "libzxn.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Size of the output queue (must be a power of 2)
+*/
+#define uiOUTQ_SIZE (0x400)
+
+/*!
+Number of characters rendered per call of "outq_drain" while waiting for data
+*/
+#define uiOUTQ_QUANTUM (0x08)
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Append data to the output queue; if the queue is full, the oldest data is
+rendered first.
+@param pcData Data to queue
+@param uiLen Number of characters
+*/
+void outq_put(const char_t* pcData, uint16_t uiLen);
+
+/*!
+Render queued data to the console
+@param uiMax Maximum number of characters to render
+@return Number of characters remaining in the queue (see "outq_count")
+*/
+uint16_t outq_drain(uint16_t uiMax);
+
+/*!
+Number of characters in the queue that can be rendered (without a held line)
+@return Number of characters
+*/
+uint16_t outq_count(void);
+
+/*!
+Hold the following data (a line that is filtered at its end); it is not
+rendered until "outq_release". A held line that fills the queue is dropped
+(with the rest of the line up to "outq_release").
+*/
+void outq_hold(void);
+
+/*!
+End the hold of "outq_hold"
+@param bKeep true = render the held data; false = remove it from the queue
+@return true = the held line is rendered; false = removed or dropped
+*/
+bool outq_release(bool bKeep);
+
+/*!
+Render all queued data to the console
+*/
+void outq_flush(void);
+
+#endif /* __OUTQ_H__ */
@@ -0,0 +1,227 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espbank.c                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Capture of large responses in 8K pages of memory (NextOS, MMU); ring         |
+| buffer that keeps the latest data, processed after the reception             |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <arch/zxn/esxdos.h>
+
+#include "libzxn.h"
+#include "espuart.h"
+#include "espbank.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Offset in a page
+*/
+#define uiESPBANK_PAGE_MASK (uiESPUART_PAGE_SIZE - 1)
+
+/*!
+Number of a page in the buffer: offset >> uiESPBANK_PAGE_SHIFT
+*/
+#define uiESPBANK_PAGE_SHIFT (13)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Pages and fill state of the capture buffer; "uiHead" counts all bytes written
+since the reset, the ring position is "uiHead % uiSize"
+*/
+static struct
+{
+  uint8_t  auiPage[uiESPBANK_MAX_PAGES];
+  uint8_t  uiPages;
+  uint32_t uiSize;
+  uint32_t uiHead;
+} g_tBank;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espbank_open()                                                             */
+/*----------------------------------------------------------------------------*/
+int espbank_open(uint8_t uiPages)
+{
+  uint8_t uiPage;
+
+  if ((0 == uiPages) || (uiESPBANK_MAX_PAGES < uiPages) || g_tBank.uiPages)
+  {
+    return EINVAL;
+  }
+
+  while (g_tBank.uiPages < uiPages)
+  {
+    if (0xFF == (uiPage = esx_ide_bank_alloc(ESX_BANKTYPE_RAM)))
+    {
+      espbank_close();
+      return ENOMEM;
+    }
+
+    g_tBank.auiPage[g_tBank.uiPages++] = uiPage;
+  }
+
+  g_tBank.uiSize = (uint32_t) uiPages * uiESPUART_PAGE_SIZE;
+  espbank_reset();
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_close()                                                            */
+/*----------------------------------------------------------------------------*/
+void espbank_close(void)
+{
+  while (g_tBank.uiPages)
+  {
+    esx_ide_bank_free(ESX_BANKTYPE_RAM, g_tBank.auiPage[--g_tBank.uiPages]);
+  }
+
+  g_tBank.uiSize = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_pages()                                                            */
+/*----------------------------------------------------------------------------*/
+uint8_t espbank_pages(void)
+{
+  return g_tBank.uiPages;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_reset()                                                            */
+/*----------------------------------------------------------------------------*/
+void espbank_reset(void)
+{
+  g_tBank.uiHead = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_write()                                                            */
+/*----------------------------------------------------------------------------*/
+void espbank_write(const char_t* pcData, uint16_t uiLen)
+{
+  uint32_t uiOffset;
+  uint16_t uiChunk;
+
+  while (uiLen)
+  {
+    uiOffset = g_tBank.uiHead % g_tBank.uiSize;
+    uiChunk  = uiESPUART_PAGE_SIZE - (uint16_t) (uiOffset & uiESPBANK_PAGE_MASK);
+
+    if (uiChunk > uiLen)
+    {
+      uiChunk = uiLen;
+    }
+
+    memcpy(espuart_map(g_tBank.auiPage[(uint8_t) (uiOffset >> uiESPBANK_PAGE_SHIFT)]) + (uint16_t) (uiOffset & uiESPBANK_PAGE_MASK),
+           pcData, uiChunk);
+    espuart_unmap();
+
+    g_tBank.uiHead += uiChunk;
+    pcData         += uiChunk;
+    uiLen          -= uiChunk;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_count()                                                            */
+/*----------------------------------------------------------------------------*/
+uint32_t espbank_count(void)
+{
+  return (g_tBank.uiHead < g_tBank.uiSize) ? g_tBank.uiHead : g_tBank.uiSize;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_lost()                                                             */
+/*----------------------------------------------------------------------------*/
+uint32_t espbank_lost(void)
+{
+  return g_tBank.uiHead - espbank_count();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_map()                                                              */
+/*----------------------------------------------------------------------------*/
+uint16_t espbank_map(uint32_t uiPos, const char_t** ppcData)
+{
+  uint32_t uiOffset;
+  uint32_t uiRest;
+  uint16_t uiChunk;
+
+  if (uiPos >= espbank_count())
+  {
+    return 0;
+  }
+
+  uiRest   = espbank_count() - uiPos;
+  uiOffset = (espbank_lost() + uiPos) % g_tBank.uiSize;
+  uiChunk  = uiESPUART_PAGE_SIZE - (uint16_t) (uiOffset & uiESPBANK_PAGE_MASK);
+
+  if (uiChunk > uiRest)
+  {
+    uiChunk = (uint16_t) uiRest;
+  }
+
+  *ppcData = (const char_t*) espuart_map(g_tBank.auiPage[(uint8_t) (uiOffset >> uiESPBANK_PAGE_SHIFT)]) +
+             (uint16_t) (uiOffset & uiESPBANK_PAGE_MASK);
+
+  return uiChunk;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espbank_unmap()                                                            */
+/*----------------------------------------------------------------------------*/
+void espbank_unmap(void)
+{
+  espuart_unmap();
+}
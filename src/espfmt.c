@@ -0,0 +1,267 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espfmt.c                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Small formatters for the output of the application (replacement of the       |
+| printf family: "%s", "%c", "%d", "%u", "%lu" and widths only)                |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "libzxn.h"
+#include "espfmt.h"
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Context of "espfmt_format": the remaining space of the buffer
+*/
+typedef struct _fmtbuffer
+{
+  char_t*  pcNext;
+  uint16_t uiFree;
+} fmtbuffer_t;
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Receiver of "espfmt_format": append to the buffer
+*/
+static void espfmt_append(const char_t* pcData, uint16_t uiLen, void* pContext);
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espfmt_u32()                                                               */
+/*----------------------------------------------------------------------------*/
+uint8_t espfmt_u32(char_t* acBuffer, uint32_t uiValue)
+{
+  char_t acDigits[uiESPFMT_MAX_DIGITS];
+  uint8_t uiLen = 0;
+  uint8_t i = 0;
+
+  /* 16 bit divisions as soon as possible; they are much cheaper on the Z80 */
+  while (0xFFFFUL < uiValue)
+  {
+    acDigits[uiLen++] = (char_t) ('0' + (uint8_t) (uiValue % 10));
+    uiValue /= 10;
+  }
+
+  for (uint16_t uiShort = (uint16_t) uiValue; ; )
+  {
+    acDigits[uiLen++] = (char_t) ('0' + (uint8_t) (uiShort % 10));
+
+    if (0 == (uiShort /= 10))
+    {
+      break;
+    }
+  }
+
+  while (uiLen)
+  {
+    acBuffer[i++] = acDigits[--uiLen];
+  }
+
+  return i;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espfmt_vprint()                                                            */
+/*----------------------------------------------------------------------------*/
+void espfmt_vprint(espfmt_sink_t pfnSink, void* pContext, const char_t* acFmt, va_list tArgs)
+{
+  char_t acNumber[uiESPFMT_MAX_DIGITS + 1];
+  const char_t* pcText;
+  uint32_t uiValue;
+  uint8_t uiWidth;
+  uint8_t uiLen;
+  char_t cPad;
+  bool bNegative;
+
+  while ('\0' != *acFmt)
+  {
+    /* Literal text up to the next conversion */
+    for (pcText = acFmt; ('\0' != *acFmt) && ('%' != *acFmt); ++acFmt)
+    {
+    }
+
+    if (acFmt != pcText)
+    {
+      pfnSink(pcText, (uint16_t) (acFmt - pcText), pContext);
+    }
+
+    if ('\0' == *acFmt++)
+    {
+      break;
+    }
+
+    cPad    = ('0' == *acFmt) ? '0' : ' ';
+    uiWidth = 0;
+
+    while (('0' <= *acFmt) && ('9' >= *acFmt))
+    {
+      uiWidth = (uint8_t) (uiWidth * 10 + (*acFmt++ - '0'));
+    }
+
+    bNegative = false;
+
+    switch (*acFmt)
+    {
+      case 's':
+        pcText = va_arg(tArgs, const char_t*);
+        pfnSink(pcText, (uint16_t) strlen(pcText), pContext);
+        ++acFmt;
+        continue;
+
+      case 'c':
+        acNumber[0] = (char_t) va_arg(tArgs, int);
+        pfnSink(acNumber, 1, pContext);
+        ++acFmt;
+        continue;
+
+      case 'd':
+      {
+        int iValue = va_arg(tArgs, int);
+
+        if ((bNegative = (0 > iValue)))
+        {
+          iValue = -iValue;
+        }
+
+        uiValue = (uint16_t) iValue;
+        break;
+      }
+
+      case 'u':
+        uiValue = va_arg(tArgs, unsigned int);
+        break;
+
+      case 'l':
+        uiValue = va_arg(tArgs, unsigned long);
+        acFmt += ('u' == acFmt[1]) ? 1 : 0;
+        break;
+
+      case '\0':
+        continue;
+
+      default: /* "%%" and unknown conversions: the character itself */
+        pfnSink(acFmt++, 1, pContext);
+        continue;
+    }
+
+    ++acFmt;
+
+    /* Sign, padding, digits */
+    uiLen = 0;
+
+    if (bNegative)
+    {
+      acNumber[uiLen++] = '-';
+    }
+
+    uiLen += espfmt_u32(&acNumber[uiLen], uiValue);
+
+    for ( ; uiWidth > uiLen; --uiWidth)
+    {
+      pfnSink(&cPad, 1, pContext);
+    }
+
+    pfnSink(acNumber, uiLen, pContext);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espfmt_print()                                                             */
+/*----------------------------------------------------------------------------*/
+void espfmt_print(espfmt_sink_t pfnSink, void* pContext, const char_t* acFmt, ...)
+{
+  va_list tArgs;
+
+  va_start(tArgs, acFmt);
+  espfmt_vprint(pfnSink, pContext, acFmt, tArgs);
+  va_end(tArgs);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espfmt_format()                                                            */
+/*----------------------------------------------------------------------------*/
+uint16_t espfmt_format(char_t* acBuffer, uint16_t uiSize, const char_t* acFmt, ...)
+{
+  fmtbuffer_t tBuffer;
+  va_list tArgs;
+
+  if (0 == uiSize)
+  {
+    return 0;
+  }
+
+  tBuffer.pcNext = acBuffer;
+  tBuffer.uiFree = uiSize - 1;
+
+  va_start(tArgs, acFmt);
+  espfmt_vprint(espfmt_append, &tBuffer, acFmt, tArgs);
+  va_end(tArgs);
+
+  *tBuffer.pcNext = '\0';
+
+  return (uint16_t) (tBuffer.pcNext - acBuffer);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espfmt_append()                                                            */
+/*----------------------------------------------------------------------------*/
+static void espfmt_append(const char_t* pcData, uint16_t uiLen, void* pContext)
+{
+  fmtbuffer_t* pBuffer = (fmtbuffer_t*) pContext;
+
+  if (uiLen > pBuffer->uiFree)
+  {
+    uiLen = pBuffer->uiFree;
+  }
+
+  memcpy(pBuffer->pcNext, pcData, uiLen);
+  pBuffer->pcNext += uiLen;
+  pBuffer->uiFree -= uiLen;
+}
@@ -0,0 +1,265 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espio.c                                                            |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Receive buffer (ring) of the ESP8266 connection: bytes are moved from the    |
+| UART into the ring and processed in place (no copies per line)               |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "libzxn.h"
+#include "espuart.h"
+#include "espio.h"
+#include "esptrace.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Mask to wrap indices of the ring buffer
+*/
+#define uiESPIO_RX_MASK (uiESPIO_RX_SIZE - 1)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Receive ring buffer; head and tail are free running indices. With interrupt
+driven reception the head is advanced by the ISR; all other accesses are
+done in critical sections.
+*/
+static struct
+{
+  volatile uint16_t uiHead;
+  volatile uint16_t uiTail;
+  volatile uint16_t uiIrqBytes;
+  bool              bIrq;
+  espio_source_t    pfnSource;
+  char_t            acData[uiESPIO_RX_SIZE];
+} g_tRx = { .pfnSource = espuart_read };
+
+/*============================================================================*/
+/*                               Prototypen                                   */
+/*============================================================================*/
+/*!
+Handler of the receive interrupt
+*/
+static void espio_isr(void);
+
+/*!
+Move all available bytes from the source to the receive buffer (no trace)
+@return Number of bytes moved
+*/
+static uint16_t espio_move(void);
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espio_lock()                                                               */
+/*----------------------------------------------------------------------------*/
+static void espio_lock(void)
+{
+  if (g_tRx.bIrq)
+  {
+    espuart_lock();
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_unlock()                                                             */
+/*----------------------------------------------------------------------------*/
+static void espio_unlock(void)
+{
+  if (g_tRx.bIrq)
+  {
+    espuart_unlock();
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_isr()                                                                */
+/*----------------------------------------------------------------------------*/
+static void espio_isr(void)
+{
+  /* Counted only: the trace is written by the foreground (see "espio_fill") */
+  g_tRx.uiIrqBytes += espio_move();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_reset()                                                              */
+/*----------------------------------------------------------------------------*/
+void espio_reset(void)
+{
+  espio_lock();
+  g_tRx.uiHead = 0;
+  g_tRx.uiTail = 0;
+  espio_unlock();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_irq()                                                                */
+/*----------------------------------------------------------------------------*/
+int espio_irq(bool bEnable)
+{
+  int iReturn = EOK;
+
+  if (bEnable && !g_tRx.bIrq)
+  {
+    if (EOK == (iReturn = espuart_irq_enable(espio_isr)))
+    {
+      g_tRx.bIrq = true;
+    }
+  }
+  else if (!bEnable && g_tRx.bIrq)
+  {
+    espuart_irq_disable();
+    g_tRx.bIrq = false;
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_source()                                                             */
+/*----------------------------------------------------------------------------*/
+void espio_source(espio_source_t pfnSource)
+{
+  espio_lock();
+  g_tRx.pfnSource = pfnSource ? pfnSource : espuart_read;
+  espio_unlock();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_move()                                                               */
+/*----------------------------------------------------------------------------*/
+static uint16_t espio_move(void)
+{
+  uint16_t uiFree;
+  uint16_t uiIndex;
+  uint16_t uiRead;
+  uint16_t uiMoved = 0;
+
+  /* At most two contiguous blocks (before/after the end of the ring) */
+  do
+  {
+    uiFree  = uiESPIO_RX_SIZE - (g_tRx.uiHead - g_tRx.uiTail);
+    uiIndex = g_tRx.uiHead & uiESPIO_RX_MASK;
+
+    if (uiFree > (uiESPIO_RX_SIZE - uiIndex))
+    {
+      uiFree = uiESPIO_RX_SIZE - uiIndex;
+    }
+
+    uiRead = uiFree ? g_tRx.pfnSource((uint8_t*) &g_tRx.acData[uiIndex], uiFree) : 0;
+    g_tRx.uiHead += uiRead;
+    uiMoved      += uiRead;
+  }
+  while (uiRead && (uiRead == uiFree));
+
+  return uiMoved;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_fill()                                                               */
+/*----------------------------------------------------------------------------*/
+uint16_t espio_fill(void)
+{
+  uint16_t uiRead = espio_move();
+
+  /* Bytes of the interrupt since the last call (empty polls are not traced) */
+  if (g_tRx.uiIrqBytes)
+  {
+    ESPTRACE(ESPTRACE_IRQ, g_tRx.uiIrqBytes);
+    g_tRx.uiIrqBytes = 0;
+  }
+
+  if (uiRead)
+  {
+    ESPTRACE(ESPTRACE_FILL, uiRead);
+  }
+
+  return g_tRx.uiHead - g_tRx.uiTail;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_span()                                                               */
+/*----------------------------------------------------------------------------*/
+uint16_t espio_span(const char_t** ppData)
+{
+  uint16_t uiCount;
+  uint16_t uiIndex;
+
+  /* Polling also with interrupts: the ISR only runs once per frame */
+  espio_lock();
+  uiCount = espio_fill();
+  uiIndex = g_tRx.uiTail & uiESPIO_RX_MASK;
+  espio_unlock();
+
+  if (uiCount > (uiESPIO_RX_SIZE - uiIndex))
+  {
+    uiCount = uiESPIO_RX_SIZE - uiIndex;
+  }
+
+  *ppData = &g_tRx.acData[uiIndex];
+
+  return uiCount;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espio_consume()                                                            */
+/*----------------------------------------------------------------------------*/
+void espio_consume(uint16_t uiCount)
+{
+  espio_lock();
+  g_tRx.uiTail += uiCount;
+  espio_unlock();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,230 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espkv.c                                                            |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Fields of common responses extracted while the lines are streamed (chunks)   |
+| and passed on as key=value records ("-e")                                    |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "libzxn.h"
+#include "espfmt.h"
+#include "espkv.h"
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Exported response: prefix of the line and the keys of its fields (separated
+by ","; an empty key skips the field)
+*/
+typedef struct _espkv_entry
+{
+  const char_t* acPrefix;
+  const char_t* acKeys;
+} espkv_entry_t;
+
+/*============================================================================*/
+/*                               Konstanten                                   */
+/*============================================================================*/
+/*!
+Exported responses; a prefix must be unique within its length
+*/
+static const espkv_entry_t g_atEntries[] =
+{
+  {"+CIFSR:STAIP,",    "IP"},
+  {"+CIFSR:STAMAC,",   "MAC"},
+  {"+CIFSR:APIP,",     "APIP"},
+  {"+CIPSTA:ip:",      "IP"},
+  {"+CIPSTA:gateway:", "GATEWAY"},
+  {"+CWJAP:",          "SSID,BSSID,CHANNEL,RSSI"},
+  {"+CWMODE:",         "MODE"},
+  {"STATUS:",          "STATUS"},
+  {"+CIPSTATUS:",      "LINK,TYPE,REMOTE,RPORT,LPORT,SERVER"}
+};
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+State of the export: the beginning of a line is collected until it matches a
+prefix; then each field is passed on as a record
+*/
+static struct
+{
+  espfmt_sink_t pfnSink;
+  void*         pContext;
+  const char_t* pcKey;      /* key of the current field; 0 = line skipped */
+  bool          bPrefix;    /* the prefix is collected */
+  bool          bQuote;     /* inside quotes */
+  bool          bOpen;      /* record of the current field started */
+  uint8_t       uiLen;      /* collected characters of the prefix */
+  char_t        acPrefix[uiESPKV_MAX_PREFIX];
+} g_tKv;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espkv_close()                                                              */
+/*----------------------------------------------------------------------------*/
+static void espkv_close(void)
+{
+  static const char_t acEnd[] = {cESPKV_END};
+
+  if (g_tKv.bOpen)
+  {
+    g_tKv.pfnSink(acEnd, 1, g_tKv.pContext);
+    g_tKv.bOpen = false;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espkv_prefix()                                                             */
+/*----------------------------------------------------------------------------*/
+static void espkv_prefix(char_t c)
+{
+  uint8_t i;
+
+  g_tKv.acPrefix[g_tKv.uiLen++] = c;
+
+  for (i = 0; i < (sizeof(g_atEntries) / sizeof(g_atEntries[0])); ++i)
+  {
+    if ((g_tKv.uiLen == strlen(g_atEntries[i].acPrefix)) &&
+        (0 == memcmp(g_tKv.acPrefix, g_atEntries[i].acPrefix, g_tKv.uiLen)))
+    {
+      g_tKv.pcKey   = g_atEntries[i].acKeys;
+      g_tKv.bPrefix = false;
+      return;
+    }
+  }
+
+  /* No exported response */
+  if (uiESPKV_MAX_PREFIX == g_tKv.uiLen)
+  {
+    g_tKv.bPrefix = false;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espkv_open()                                                               */
+/*----------------------------------------------------------------------------*/
+void espkv_open(espfmt_sink_t pfnSink, void* pContext)
+{
+  g_tKv.pfnSink  = pfnSink;
+  g_tKv.pContext = pContext;
+  g_tKv.bOpen    = false;
+  g_tKv.bPrefix  = false;
+  g_tKv.pcKey    = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espkv_active()                                                             */
+/*----------------------------------------------------------------------------*/
+bool espkv_active(void)
+{
+  return (0 != g_tKv.pfnSink);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espkv_line()                                                               */
+/*----------------------------------------------------------------------------*/
+void espkv_line(void)
+{
+  espkv_close();
+
+  g_tKv.pcKey   = 0;
+  g_tKv.bPrefix = true;
+  g_tKv.bQuote  = false;
+  g_tKv.uiLen   = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espkv_feed()                                                               */
+/*----------------------------------------------------------------------------*/
+void espkv_feed(const char_t* pcData, uint16_t uiLen)
+{
+  char_t c;
+
+  while (uiLen--)
+  {
+    c = *pcData++;
+
+    if (g_tKv.bPrefix)
+    {
+      espkv_prefix(c);
+    }
+    else if (!g_tKv.pcKey)
+    {
+      return; /* Rest of a skipped line */
+    }
+    else if ('"' == c)
+    {
+      g_tKv.bQuote = !g_tKv.bQuote;
+    }
+    else if ((',' == c) && !g_tKv.bQuote)
+    {
+      /* Next field: next key (0 = no more keys, rest of the line skipped) */
+      espkv_close();
+      g_tKv.pcKey += strcspn(g_tKv.pcKey, ",");
+      g_tKv.pcKey  = (',' == *g_tKv.pcKey) ? (g_tKv.pcKey + 1) : 0;
+    }
+    else if (g_tKv.bOpen)
+    {
+      g_tKv.pfnSink(&c, 1, g_tKv.pContext);
+    }
+    else if (',' != *g_tKv.pcKey)
+    {
+      /* First character of a field: "KEY=" */
+      g_tKv.pfnSink(g_tKv.pcKey, strcspn(g_tKv.pcKey, ","), g_tKv.pContext);
+      g_tKv.pfnSink("=", 1, g_tKv.pContext);
+      g_tKv.pfnSink(&c, 1, g_tKv.pContext);
+      g_tKv.bOpen = true;
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
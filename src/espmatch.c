@@ -0,0 +1,181 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espmatch.c                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Patterns matched against received lines while they are streamed (chunks);    |
+| used to end commands early ("-w", "-x")                                      |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "libzxn.h"
+#include "espmatch.h"
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Patterns; the state of a pattern has one bit per matched prefix length
+("shift-and"), so a line is matched character by character without a copy
+*/
+static struct
+{
+  uint8_t uiCount;
+  uint8_t uiTags;
+
+  struct
+  {
+    char_t   acText[uiESPMATCH_MAX_LEN];
+    uint8_t  uiLen;
+    uint8_t  uiTag;
+    uint16_t uiState;
+  } atPattern[uiESPMATCH_MAX_PATTERNS];
+} g_tMatch;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espmatch_reset()                                                           */
+/*----------------------------------------------------------------------------*/
+void espmatch_reset(void)
+{
+  g_tMatch.uiCount = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espmatch_add()                                                             */
+/*----------------------------------------------------------------------------*/
+int espmatch_add(const char_t* acPattern, uint8_t uiTag)
+{
+  uint16_t uiLen = strlen(acPattern);
+
+  if ((uiESPMATCH_MAX_PATTERNS == g_tMatch.uiCount) || (0 == uiLen) || (uiESPMATCH_MAX_LEN < uiLen))
+  {
+    return ERANGE;
+  }
+
+  memcpy(g_tMatch.atPattern[g_tMatch.uiCount].acText, acPattern, uiLen);
+  g_tMatch.atPattern[g_tMatch.uiCount].uiLen   = (uint8_t) uiLen;
+  g_tMatch.atPattern[g_tMatch.uiCount].uiTag   = uiTag;
+  g_tMatch.atPattern[g_tMatch.uiCount].uiState = 0;
+  ++g_tMatch.uiCount;
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espmatch_count()                                                           */
+/*----------------------------------------------------------------------------*/
+uint8_t espmatch_count(void)
+{
+  return g_tMatch.uiCount;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espmatch_line()                                                            */
+/*----------------------------------------------------------------------------*/
+void espmatch_line(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < g_tMatch.uiCount; ++i)
+  {
+    g_tMatch.atPattern[i].uiState = 0;
+  }
+
+  g_tMatch.uiTags = 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espmatch_feed()                                                            */
+/*----------------------------------------------------------------------------*/
+uint8_t espmatch_feed(const char_t* pcData, uint16_t uiLen)
+{
+  uint16_t uiActive;
+  uint16_t uiState;
+  uint16_t uiBit;
+  uint8_t i;
+  uint8_t j;
+  char_t c;
+
+  while (uiLen--)
+  {
+    c = *pcData++;
+
+    for (i = 0; i < g_tMatch.uiCount; ++i)
+    {
+      /* A tag is set once per line */
+      if (g_tMatch.uiTags & g_tMatch.atPattern[i].uiTag)
+      {
+        continue;
+      }
+
+      /* Only the successors of matched prefixes (and the start) are tested */
+      uiActive = (g_tMatch.atPattern[i].uiState << 1) | 1;
+      uiState  = 0;
+
+      for (j = 0, uiBit = 1; (j < g_tMatch.atPattern[i].uiLen) && (uiBit <= uiActive); ++j, uiBit <<= 1)
+      {
+        if ((uiActive & uiBit) &&
+            ((g_tMatch.atPattern[i].acText[j] == c) || ('?' == g_tMatch.atPattern[i].acText[j])))
+        {
+          uiState |= uiBit;
+        }
+      }
+
+      g_tMatch.atPattern[i].uiState = uiState;
+
+      if (uiState & (1 << (g_tMatch.atPattern[i].uiLen - 1)))
+      {
+        g_tMatch.uiTags |= g_tMatch.atPattern[i].uiTag;
+      }
+    }
+  }
+
+  return g_tMatch.uiTags;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
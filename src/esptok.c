@@ -0,0 +1,448 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: esptok.c                                                           |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Single-pass scanner of the responses of the ESP8266: finds line boundaries,  |
+| trims and classifies the lines (prefix table) in place in the receive buffer |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "libzxn.h"
+#include "esptok.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Number of entries in the prefix table
+*/
+#define uiESPTOK_ENTRIES (sizeof(g_atPrefix) / sizeof(g_atPrefix[0]))
+
+/*============================================================================*/
+/*                               Typ-Definitionen                             */
+/*============================================================================*/
+/*!
+Entry of the prefix table
+*/
+typedef struct _espprefix
+{
+  /*!
+  Text at the beginning of the line
+  */
+  const char_t* acText;
+
+  /*!
+  Length of the text
+  */
+  uint8_t uiLen;
+
+  /*!
+  Classification of matching lines
+  */
+  uint8_t eToken;
+
+  /*!
+  true = the line has to end after the text; false = the text is a prefix
+  */
+  bool bExact;
+} espprefix_t;
+
+/*============================================================================*/
+/*                               Konstanten                                   */
+/*============================================================================*/
+/*!
+Vocabulary of the ESP8266 (AT firmware); the lines are matched against all
+entries in parallel, one character per step (bit mask of candidates)
+*/
+static const espprefix_t g_atPrefix[] =
+{
+  { "OK",        2, ESPTOK_OK,        true  },
+  { "ERROR",     5, ESPTOK_ERROR,     true  },
+  { "FAIL",      4, ESPTOK_FAIL,      true  },
+  { "SEND OK",   7, ESPTOK_SEND_OK,   true  },
+  { "SEND FAIL", 9, ESPTOK_SEND_FAIL, true  },
+  { "ready",     5, ESPTOK_READY,     true  },
+  { "busy ",     5, ESPTOK_BUSY,      false },
+  { "+IPD,",     5, ESPTOK_IPD,       false },
+  { "WIFI ",     5, ESPTOK_WIFI,      false }
+};
+
+/*!
+Source of trimmed spaces, that turned out to be inside of a line
+*/
+static const char_t g_acSpaces[] = "        ";
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+State of the scanner
+*/
+static struct
+{
+  /*!
+  Receiver of the content of printable lines
+  */
+  esptok_sink_t pfnSink;
+
+  /*!
+  Candidates of the prefix table (bit n = entry n); 0 = line is classified
+  */
+  uint16_t uiMask;
+
+  /*!
+  Number of characters of the line matched against the prefix table
+  */
+  uint8_t uiPos;
+
+  /*!
+  Classification of the current line (valid if uiMask is 0)
+  */
+  esptoken_t eToken;
+
+  /*!
+  Number of spaces held back (trailing spaces are removed)
+  */
+  uint16_t uiSpaces;
+
+  /*!
+  Number of spaces after a complete exact text (e.g. "OK "); the line still
+  matches, unless anything else follows
+  */
+  uint16_t uiTrail;
+
+  /*!
+  true = no content of the current line passed to the sink yet
+  */
+  bool bFirst;
+
+  /*!
+  true = detect the data prompt (">")
+  */
+  bool bPrompt;
+} g_tTok;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* esptok_line()                                                              */
+/*----------------------------------------------------------------------------*/
+static void esptok_line(void)
+{
+  g_tTok.uiMask   = (1 << uiESPTOK_ENTRIES) - 1;
+  g_tTok.uiPos    = 0;
+  g_tTok.eToken   = ESPTOK_DATA;
+  g_tTok.uiSpaces = 0;
+  g_tTok.uiTrail  = 0;
+  g_tTok.bFirst   = true;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_emit()                                                              */
+/*----------------------------------------------------------------------------*/
+static void esptok_emit(const char_t* pcData, uint16_t uiLen)
+{
+  uint16_t uiEnd = uiLen;
+  uint16_t uiChunk;
+
+  while (uiEnd && (' ' == pcData[uiEnd - 1]))
+  {
+    --uiEnd;
+  }
+
+  if (uiEnd && !g_tTok.pfnSink)
+  {
+    g_tTok.bFirst = false; /* Lines are classified only */
+  }
+  else if (uiEnd)
+  {
+    /* Spaces held back are inside of the line */
+    while (g_tTok.uiSpaces)
+    {
+      uiChunk = g_tTok.uiSpaces;
+
+      if (uiChunk > (sizeof(g_acSpaces) - 1))
+      {
+        uiChunk = sizeof(g_acSpaces) - 1;
+      }
+
+      g_tTok.pfnSink(g_acSpaces, uiChunk, g_tTok.bFirst);
+      g_tTok.uiSpaces -= uiChunk;
+      g_tTok.bFirst    = false;
+    }
+
+    g_tTok.pfnSink(pcData, uiEnd, g_tTok.bFirst);
+    g_tTok.bFirst = false;
+  }
+
+  g_tTok.uiSpaces += uiLen - uiEnd;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_head()                                                              */
+/*----------------------------------------------------------------------------*/
+/*
+The characters matched so far are identical to the text of every remaining
+candidate: they are passed to the sink from the prefix table.
+*/
+static void esptok_head(uint16_t uiMask)
+{
+  uint8_t i = 0;
+
+  if (g_tTok.uiPos)
+  {
+    while (!(uiMask & (1 << i)))
+    {
+      ++i;
+    }
+
+    esptok_emit(g_atPrefix[i].acText, g_tTok.uiPos);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_match()                                                             */
+/*----------------------------------------------------------------------------*/
+/*
+Next character of an unclassified line
+*/
+static void esptok_match(const char_t* pc)
+{
+  uint16_t uiMask = 0;
+  uint16_t uiBit  = 1;
+  const espprefix_t* pEntry = g_atPrefix;
+  uint8_t i;
+
+  for (i = 0; i < uiESPTOK_ENTRIES; ++i, ++pEntry, uiBit <<= 1)
+  {
+    if ((g_tTok.uiMask & uiBit) &&
+        (pEntry->uiLen > g_tTok.uiPos) &&
+        (pEntry->acText[g_tTok.uiPos] == *pc))
+    {
+      uiMask |= uiBit;
+
+      /* Complete prefix: the rest of the line is content */
+      if (!pEntry->bExact && ((g_tTok.uiPos + 1) == pEntry->uiLen))
+      {
+        g_tTok.eToken = pEntry->eToken;
+        ++g_tTok.uiPos;
+        esptok_head(uiBit);
+        g_tTok.uiMask = 0;
+        return;
+      }
+    }
+  }
+
+  if (uiMask)
+  {
+    g_tTok.uiMask = uiMask;
+    ++g_tTok.uiPos;
+    return;
+  }
+
+  /* Trailing spaces of some firmwares: only complete exact texts remain */
+  if (' ' == *pc)
+  {
+    pEntry = g_atPrefix;
+    uiBit  = 1;
+
+    for (i = 0; i < uiESPTOK_ENTRIES; ++i, ++pEntry, uiBit <<= 1)
+    {
+      if ((g_tTok.uiMask & uiBit) && pEntry->bExact && (pEntry->uiLen == g_tTok.uiPos))
+      {
+        uiMask |= uiBit;
+      }
+    }
+
+    if (uiMask)
+    {
+      g_tTok.uiMask = uiMask;
+      ++g_tTok.uiTrail;
+      return;
+    }
+  }
+
+  /* No candidate left: data line; the spaces after the text are inside */
+  esptok_head(g_tTok.uiMask);
+  g_tTok.uiMask    = 0;
+  g_tTok.uiSpaces += g_tTok.uiTrail;
+  esptok_emit(pc, 1);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_end()                                                               */
+/*----------------------------------------------------------------------------*/
+/*
+End of line; returns the classification or ESPTOK_NONE for empty lines
+*/
+static esptoken_t esptok_end(void)
+{
+  esptoken_t eToken = g_tTok.eToken;
+  const espprefix_t* pEntry = g_atPrefix;
+  uint16_t uiBit = 1;
+  uint8_t i;
+
+  if (g_tTok.uiMask)
+  {
+    for (i = 0; i < uiESPTOK_ENTRIES; ++i, ++pEntry, uiBit <<= 1)
+    {
+      if ((g_tTok.uiMask & uiBit) && pEntry->bExact && (pEntry->uiLen == g_tTok.uiPos))
+      {
+        esptok_line();
+        return (esptoken_t) pEntry->eToken;
+      }
+    }
+
+    esptok_head(g_tTok.uiMask);
+  }
+
+  if (g_tTok.bFirst)
+  {
+    eToken = ESPTOK_NONE; /* Empty line */
+  }
+
+  esptok_line();
+
+  return eToken;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_reset()                                                             */
+/*----------------------------------------------------------------------------*/
+void esptok_reset(esptok_sink_t pfnSink)
+{
+  g_tTok.pfnSink = pfnSink;
+  esptok_line();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_prompt()                                                            */
+/*----------------------------------------------------------------------------*/
+void esptok_prompt(bool bEnable)
+{
+  g_tTok.bPrompt = bEnable;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_scan()                                                              */
+/*----------------------------------------------------------------------------*/
+uint16_t esptok_scan(const char_t* pcData, uint16_t uiCount, esptoken_t* peToken)
+{
+  uint16_t uiStart;
+  uint16_t i = 0;
+  char_t c;
+
+  *peToken = ESPTOK_NONE;
+
+  while (i < uiCount)
+  {
+    /* Classified line: pass everything up to the end of line as one chunk */
+    if (!g_tTok.uiMask)
+    {
+      uiStart = i;
+      while ((i < uiCount) && ('\r' != pcData[i]) && ('\n' != pcData[i]))
+      {
+        ++i;
+      }
+
+      if (i > uiStart)
+      {
+        esptok_emit(&pcData[uiStart], i - uiStart);
+      }
+
+      if (i == uiCount)
+      {
+        break;
+      }
+    }
+
+    c = pcData[i];
+
+    if ('\n' == c)
+    {
+      ++i;
+
+      if (ESPTOK_NONE != (*peToken = esptok_end()))
+      {
+        break;
+      }
+    }
+    else if (('>' == c) && g_tTok.bPrompt && g_tTok.uiMask && !g_tTok.uiPos)
+    {
+      ++i;
+      *peToken = ESPTOK_PROMPT;
+      break;
+    }
+    else if ('\r' != c)
+    {
+      esptok_match(&pcData[i++]);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+
+  return i;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptok_final()                                                             */
+/*----------------------------------------------------------------------------*/
+bool esptok_final(esptoken_t eToken)
+{
+  return (ESPTOK_OK        == eToken) ||
+         (ESPTOK_ERROR     == eToken) ||
+         (ESPTOK_FAIL      == eToken) ||
+         (ESPTOK_SEND_OK   == eToken) ||
+         (ESPTOK_SEND_FAIL == eToken) ||
+         (ESPTOK_PROMPT    == eToken);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,168 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: esptrace.c                                                         |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Compact in-memory event trace (build option "__TRACE__"): the time stamps    |
+| are raw ticks of the UART module and converted by the dump                   |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <arch/zxn/esxdos.h>
+
+#include "libzxn.h"
+#include "espuart.h"
+#include "espfmt.h"
+#include "esptrace.h"
+
+#if defined(__TRACE__)
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Mask to wrap the index of the events
+*/
+#define uiESPTRACE_MASK (uiESPTRACE_ENTRIES - 1)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Recorded events; "uiCount" is free running (number of events since start)
+*/
+static struct
+{
+  uint16_t uiCount;
+
+  struct
+  {
+    uint32_t uiTicks;
+    uint16_t uiData;
+    uint8_t  uiEvent;
+  } atEntry[uiESPTRACE_ENTRIES];
+} g_tTrace;
+
+/*!
+Names of the events in the dump (see "esptrace_event_t")
+*/
+static const char_t* const g_acEvents[] =
+{
+  "-", "fill", "tx", "line", "render", "block", "timeout", "budget", "probe", "baud", "irq"
+};
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* esptrace_event()                                                           */
+/*----------------------------------------------------------------------------*/
+void esptrace_event(esptrace_event_t eEvent, uint16_t uiData)
+{
+  /* Foreground only: the receive interrupt counts its bytes in "espio" */
+  uint8_t uiIndex = (uint8_t) (g_tTrace.uiCount++ & uiESPTRACE_MASK);
+
+  g_tTrace.atEntry[uiIndex].uiTicks = espuart_ticks();
+  g_tTrace.atEntry[uiIndex].uiData  = uiData;
+  g_tTrace.atEntry[uiIndex].uiEvent = (uint8_t) eEvent;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptrace_sink()                                                            */
+/*----------------------------------------------------------------------------*/
+static void esptrace_sink(const char_t* pcData, uint16_t uiLen, void* pContext)
+{
+  uint8_t hFile = *((uint8_t*) pContext);
+
+  if (0xFF != hFile)
+  {
+    esx_f_write(hFile, pcData, uiLen);
+  }
+  else
+  {
+    fwrite(pcData, 1, uiLen, stdout);
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* esptrace_dump()                                                            */
+/*----------------------------------------------------------------------------*/
+void esptrace_dump(void)
+{
+  uint16_t uiFirst = 0;
+  uint16_t i;
+  uint32_t uiStart;
+  uint8_t uiIndex;
+  uint8_t uiEvent;
+  uint8_t hFile;
+
+  if (uiESPTRACE_ENTRIES < g_tTrace.uiCount)
+  {
+    uiFirst = g_tTrace.uiCount - uiESPTRACE_ENTRIES;
+  }
+
+  hFile = esx_f_open(acESPTRACE_FILE, ESX_MODE_WRITE | ESX_MODE_OPEN_CREAT_TRUNC);
+
+  espfmt_print(esptrace_sink, &hFile, "trace: %u events, %u lost\n",
+               g_tTrace.uiCount, uiFirst);
+
+  uiStart = espuart_ticks_us(g_tTrace.atEntry[uiFirst & uiESPTRACE_MASK].uiTicks);
+
+  for (i = uiFirst; i != g_tTrace.uiCount; ++i)
+  {
+    uiIndex = (uint8_t) (i & uiESPTRACE_MASK);
+    uiEvent = g_tTrace.atEntry[uiIndex].uiEvent;
+
+    espfmt_print(esptrace_sink, &hFile, "%lu %s %u\n",
+                 (unsigned long) (espuart_ticks_us(g_tTrace.atEntry[uiIndex].uiTicks) - uiStart),
+                 (uiEvent < (sizeof(g_acEvents) / sizeof(g_acEvents[0]))) ? g_acEvents[uiEvent] : "?",
+                 g_tTrace.atEntry[uiIndex].uiData);
+  }
+
+  if (0xFF != hFile)
+  {
+    esx_f_close(hFile);
+  }
+}
+
+#endif /* __TRACE__ */
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,497 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: espuart.c                                                          |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Hardware access to the UART of the ZX Spectrum Next (ESP8266)                |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <arch/zxn.h>
+#include <im2.h>
+#include <intrinsic.h>
+#include <z80.h>
+#include <input.h>
+
+#include "libzxn.h"
+#include "espuart.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Status register of the UART: receive FIFO not empty
+*/
+#define uiESPUART_RX_AVAIL (0x01)
+
+/*!
+Status register of the UART: receive FIFO overflowed (data lost)
+*/
+#define uiESPUART_RX_OVERFLOW (0x04)
+
+/*!
+Status register of the UART: receive FIFO filled above 3/4 (RTS released
+with flow control)
+*/
+#define uiESPUART_RX_NEAR_FULL (0x08)
+
+/*!
+Frame register of the UART: hardware flow control (RTS/CTS)
+*/
+#define uiESPUART_FRAME_FLOW (0x20)
+
+/*!
+Status register of the UART: transmit FIFO full
+*/
+#define uiESPUART_TX_FULL (0x02)
+
+/*!
+System variable "FRAMES" (incremented by the frame interrupt)
+*/
+#define uiESPUART_FRAMES (0x5C78)
+
+/*!
+Peripheral 1 setting (NextReg 0x05): refresh rate of the video (set = 60 Hz)
+*/
+#define uiESPUART_REG_PERIPHERAL_1 (0x05)
+#define uiESPUART_RATE_60HZ        (0x04)
+
+/*!
+System variable "RAMTOP"
+*/
+#define uiESPUART_RAMTOP (0x5CB2)
+
+/*!
+Value of the IM2 vector table; the ISR is entered at 0xFEFE
+*/
+#define uiESPUART_IM2_VECTOR (0xFE)
+
+/*!
+Address of the jump to the ISR
+*/
+#define uiESPUART_IM2_JUMP (0xFEFE)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Frame register of the UART (bits per frame, parity, stop bits, flow control)
+*/
+__sfr __banked __at 0x163B IO_ESPUART_FRAME;
+
+/*!
+Counters of the receive FIFO (incremented by "espuart_read", also in the ISR)
+*/
+static espuart_stats_t g_tStats;
+
+/*!
+Handler of the receive interrupt
+*/
+static volatile espuart_handler_t g_pfnHandler = 0;
+
+/*!
+Window of "espuart_map": MMU slot, the page mapped there before and the
+mapped page (0xFF = none)
+*/
+static struct
+{
+  uint8_t uiSlot;
+  uint8_t uiSaved;
+  uint8_t uiPage;
+} g_tWindow = { 6, 0xFF, 0xFF };
+
+/*!
+Key reported by the last call of "espuart_key" (0 = none)
+*/
+static uint8_t g_uiKey = 0;
+
+/*!
+Timing of the video (frame interrupt, raster lines): 50 Hz and 60 Hz
+*/
+static const struct
+{
+  uint16_t uiFrameUs;  /* duration of one frame [us] */
+  uint16_t uiLines;    /* lines per frame */
+  uint16_t uiIntLine;  /* raster line (active video line) of the interrupt */
+  uint8_t  uiLineUs;   /* duration of one line [us] */
+  uint8_t  uiPerSecond;
+} g_atTiming[2] =
+{
+  {20000, 312, 248, 64, 50},
+  {16667, 264, 224, 63, 60}
+};
+
+/*!
+Index of the timing in "g_atTiming" (0xFF = not read yet)
+*/
+static uint8_t g_uiTiming = 0xFF;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* espuart_isr()                                                              */
+/*----------------------------------------------------------------------------*/
+/*
+The ROM (IM1) handler is called after the ISR, so that "FRAMES" and the
+keyboard are maintained as usual.
+*/
+IM2_DEFINE_ISR_WITH_BASIC(espuart_isr)
+{
+  if (g_pfnHandler)
+  {
+    g_pfnHandler();
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_read()                                                             */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_read(uint8_t* pDst, uint16_t uiSize)
+{
+  uint16_t uiCount = 0;
+  uint8_t uiStatus = IO_UART_STATUS;
+
+  /* The flags are sampled once per read: no extra accesses per byte */
+  if (uiStatus & uiESPUART_RX_NEAR_FULL)
+  {
+    ++g_tStats.uiThrottled;
+  }
+
+  if (uiStatus & uiESPUART_RX_OVERFLOW)
+  {
+    ++g_tStats.uiOverruns;
+  }
+
+  while ((uiCount < uiSize) && (uiStatus & uiESPUART_RX_AVAIL))
+  {
+    pDst[uiCount++] = IO_UART_RX;
+    uiStatus = IO_UART_STATUS;
+  }
+
+  return uiCount;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_stats()                                                            */
+/*----------------------------------------------------------------------------*/
+void espuart_stats(espuart_stats_t* pStats)
+{
+  /* The counters are updated by the receive interrupt ("-I") as well */
+  espuart_lock();
+  *pStats = g_tStats;
+  g_tStats.uiThrottled = 0;
+  g_tStats.uiOverruns  = 0;
+  espuart_unlock();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_flow()                                                             */
+/*----------------------------------------------------------------------------*/
+void espuart_flow(bool bEnable)
+{
+  uint8_t uiFrame = IO_ESPUART_FRAME;
+
+  IO_ESPUART_FRAME = bEnable ? (uiFrame | uiESPUART_FRAME_FLOW) : (uiFrame & ~uiESPUART_FRAME_FLOW);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_write()                                                            */
+/*----------------------------------------------------------------------------*/
+void espuart_write(const uint8_t* pSrc, uint16_t uiSize)
+{
+  while (uiSize--)
+  {
+    while (IO_UART_STATUS & uiESPUART_TX_FULL)
+    {
+      /* Wait for space in the FIFO */
+    }
+
+    IO_UART_TX = *pSrc++;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_timing()                                                           */
+/*----------------------------------------------------------------------------*/
+/*
+The refresh rate is read once: the clock must not change its rate while it
+measures.
+*/
+static uint8_t espuart_timing(void)
+{
+  if (0xFF == g_uiTiming)
+  {
+    g_uiTiming = (ZXN_READ_REG(uiESPUART_REG_PERIPHERAL_1) & uiESPUART_RATE_60HZ) ? 1 : 0;
+  }
+
+  return g_uiTiming;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_clock()                                                            */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_clock(void)
+{
+  /* 50 Hz: 20 ms per frame; 60 Hz: 50 ms per 3 frames */
+  if (0 == espuart_timing())
+  {
+    return (uint16_t) (*((volatile uint16_t*) uiESPUART_FRAMES) * 20);
+  }
+
+  return (uint16_t) (((*((volatile uint32_t*) uiESPUART_FRAMES) & 0x00FFFFFFUL) * 50) / 3);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_seconds()                                                          */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_seconds(void)
+{
+  /* "FRAMES" is a 24 bit counter */
+  uint32_t uiFrames = *((volatile uint32_t*) uiESPUART_FRAMES) & 0x00FFFFFFUL;
+
+  return (uint16_t) (uiFrames / g_atTiming[espuart_timing()].uiPerSecond);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_frame_us()                                                         */
+/*----------------------------------------------------------------------------*/
+static uint32_t espuart_frame_us(uint8_t uiTiming, uint32_t uiFrames, uint16_t uiLine)
+{
+  uint16_t uiIntLine = g_atTiming[uiTiming].uiIntLine;
+
+  /* Lines since the frame interrupt */
+  uiLine = (uiLine >= uiIntLine) ? (uiLine - uiIntLine) :
+                                   (uiLine + g_atTiming[uiTiming].uiLines - uiIntLine);
+
+  return (uiFrames * g_atTiming[uiTiming].uiFrameUs) + ((uint32_t) uiLine * g_atTiming[uiTiming].uiLineUs);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_micros()                                                           */
+/*----------------------------------------------------------------------------*/
+uint32_t espuart_micros(void)
+{
+  uint8_t  uiTiming = espuart_timing();
+  uint32_t uiFrames;
+  uint16_t uiLine;
+
+  /* Consistent pair of frame counter and raster line */
+  do
+  {
+    uiFrames = *((volatile uint32_t*) uiESPUART_FRAMES) & 0x00FFFFFFUL;
+    uiLine   = ((uint16_t) (ZXN_READ_REG(REG_ACTIVE_VIDEO_LINE_H) & 0x01) << 8) |
+               ZXN_READ_REG(REG_ACTIVE_VIDEO_LINE_L);
+  }
+  while (uiFrames != (*((volatile uint32_t*) uiESPUART_FRAMES) & 0x00FFFFFFUL));
+
+  return espuart_frame_us(uiTiming, uiFrames, uiLine);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_ticks()                                                            */
+/*----------------------------------------------------------------------------*/
+uint32_t espuart_ticks(void)
+{
+  uint16_t uiFrames;
+  uint16_t uiLine;
+
+  /* Consistent pair of frame counter and raster line */
+  do
+  {
+    uiFrames = *((volatile uint16_t*) uiESPUART_FRAMES);
+    uiLine   = ((uint16_t) (ZXN_READ_REG(REG_ACTIVE_VIDEO_LINE_H) & 0x01) << 8) |
+               ZXN_READ_REG(REG_ACTIVE_VIDEO_LINE_L);
+  }
+  while (uiFrames != *((volatile uint16_t*) uiESPUART_FRAMES));
+
+  return ((uint32_t) uiFrames << 16) | uiLine;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_ticks_us()                                                         */
+/*----------------------------------------------------------------------------*/
+uint32_t espuart_ticks_us(uint32_t uiTicks)
+{
+  return espuart_frame_us(espuart_timing(), uiTicks >> 16, (uint16_t) uiTicks);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_irq_enable()                                                       */
+/*----------------------------------------------------------------------------*/
+int espuart_irq_enable(espuart_handler_t pfnHandler)
+{
+  /* The vector table has to be above RAMTOP */
+  if (espuart_ramtop() >= uiESPUART_IM2_TABLE)
+  {
+    return ENOMEM;
+  }
+
+  intrinsic_di();
+
+  g_pfnHandler = pfnHandler;
+
+  memset((void*) uiESPUART_IM2_TABLE, uiESPUART_IM2_VECTOR, 257);
+  z80_bpoke(uiESPUART_IM2_JUMP, 0xC3); /* jp espuart_isr */
+  z80_wpoke(uiESPUART_IM2_JUMP + 1, (uint16_t) espuart_isr);
+  im2_init((void*) uiESPUART_IM2_TABLE);
+
+  intrinsic_ei();
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_irq_disable()                                                      */
+/*----------------------------------------------------------------------------*/
+void espuart_irq_disable(void)
+{
+  if (g_pfnHandler)
+  {
+    intrinsic_di();
+    intrinsic_im_1();
+    g_pfnHandler = 0;
+    intrinsic_ei();
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_map()                                                              */
+/*----------------------------------------------------------------------------*/
+uint8_t* espuart_map(uint8_t uiPage)
+{
+  uint8_t uiStack; /* The address of a local variable locates the stack */
+
+  g_tWindow.uiSlot  = (6 == ((uint16_t) &uiStack >> 13)) ? 5 : 6;
+  g_tWindow.uiSaved = ZXN_READ_REG(REG_MMU0 + g_tWindow.uiSlot);
+  g_tWindow.uiPage  = uiPage;
+
+  ZXN_WRITE_REG(REG_MMU0 + g_tWindow.uiSlot, uiPage);
+
+  return (uint8_t*) ((uint16_t) g_tWindow.uiSlot << 13);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_unmap()                                                            */
+/*----------------------------------------------------------------------------*/
+void espuart_unmap(void)
+{
+  ZXN_WRITE_REG(REG_MMU0 + g_tWindow.uiSlot, g_tWindow.uiSaved);
+  g_tWindow.uiPage = 0xFF;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_mapped()                                                           */
+/*----------------------------------------------------------------------------*/
+uint8_t espuart_mapped(void)
+{
+  return g_tWindow.uiPage;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_ramtop()                                                           */
+/*----------------------------------------------------------------------------*/
+uint16_t espuart_ramtop(void)
+{
+  return z80_wpeek(uiESPUART_RAMTOP);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_memory()                                                           */
+/*----------------------------------------------------------------------------*/
+uint8_t* espuart_memory(uint16_t uiAddress)
+{
+  return (uint8_t*) uiAddress;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_key()                                                              */
+/*----------------------------------------------------------------------------*/
+uint8_t espuart_key(void)
+{
+  uint8_t uiKey = (uint8_t) in_inkey();
+
+  /* Still held down: reported already */
+  if (uiKey == g_uiKey)
+  {
+    return 0;
+  }
+
+  return (g_uiKey = uiKey);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_lock()                                                             */
+/*----------------------------------------------------------------------------*/
+void espuart_lock(void)
+{
+  intrinsic_di();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* espuart_unlock()                                                           */
+/*----------------------------------------------------------------------------*/
+void espuart_unlock(void)
+{
+  intrinsic_ei();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
@@ -39,10 +39,12 @@
 /*============================================================================*/
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <ctype.h>
 #include <errno.h>
 #include <arch/zxn.h>
 #include <arch/zxn/esxdos.h>
@@ -50,12 +52,117 @@
 #include "libzxn.h"
 #include "libuart.h"
 #include "libesp.h"
+#include "espuart.h"
+#include "espio.h"
+#include "outq.h"
+#include "esptok.h"
+#include "espmatch.h"
+#include "espfmt.h"
+#include "espbank.h"
+#include "espkv.h"
+#include "esptrace.h"
 #include "espcmd.h"
 #include "version.h"
 
 /*============================================================================*/
 /*                               Defines                                      */
 /*============================================================================*/
+/*!
+Timeout of the requests to negotiate the "turbo" baudrate [ms]
+*/
+#define uiTURBO_TIMEOUT (100)
+
+/*!
+Silence before and after the escape sequence "+++" of the transparent mode [ms]
+*/
+#define uiXFER_GUARD (100)
+
+/*!
+Time the ESP8266 needs to leave the transparent mode after "+++" [ms]
+*/
+#define uiXFER_ESCAPE (1000)
+
+/*!
+First backoff before a retry of a command; doubled for each retry [ms]
+*/
+#define uiRETRY_BACKOFF (250)
+
+/*!
+Limit of the backoff before a retry [ms]
+*/
+#define uiRETRY_BACKOFF_MAX (8000)
+
+/*!
+Timeout of the "AT" probe before a retry [ms]
+*/
+#define uiRETRY_PROBE (200)
+
+/*!
+Probe to synchronize the link to the ESP8266 at the start of a session
+*/
+#define acSYNC_PROBE "AT"
+
+/*!
+Number of characters of the echo of the sync probe
+*/
+#define uiSYNC_ECHO (2)
+
+/*!
+Line that is not the echo of the sync probe
+*/
+#define uiSYNC_NO_ECHO (0xFF)
+
+/*!
+Period of the sync probes [ms]; received data does not delay the next probe.
+Three ticks of "espuart_clock": the measured period is at least two frames
+*/
+#define uiSYNC_PROBE (3 * uiESPUART_CLOCK_TICK)
+
+/*!
+Number of sync probes of a full initialization; the sync fails after the
+period of the last probe (hard limit from the start of the sync)
+*/
+#define uiSYNC_PROBES (5)
+
+/*!
+Number of sync probes that verify a cached link above the default baudrate
+(an ESP8266 reset in the meantime is back at its default rate)
+*/
+#define uiCACHE_PROBES (2)
+
+/*!
+Number of sync probes per candidate of the baudrate detection ("-b auto")
+*/
+#define uiAUTOBAUD_PROBES (2)
+
+/*!
+Hard limit of the baudrate detection from its start [ms]
+*/
+#define uiAUTOBAUD_LIMIT (1500)
+
+/*!
+Time without data that ends a burst of unsolicited messages ("-i") [ms]
+*/
+#define uiREPL_SETTLE (2 * uiESPUART_CLOCK_TICK)
+
+/*!
+First line of a new timing log ("-L")
+*/
+#define acTIMING_HEADER "cmd,result,time_s,setup_us,first_us,final_us,print_us,lines,bytes,rate,retries,baudrate,throttled,overruns,firmware\n"
+
+/*!
+Range of the baudrate of the command line ("-b")
+*/
+#define uiMIN_BAUDRATE (1200)
+#define uiMAX_BAUDRATE (2000000)
+
+/*!
+Results of "readLine" besides the length of a line: end of file, read error
+of esxDOS and a line that does not fit into the buffer (skipped)
+*/
+#define iLINE_EOF      (-1)
+#define iLINE_ERROR    (-2)
+#define iLINE_TOO_LONG (-3)
 
 /*============================================================================*/
 /*                               Namespaces                                   */
@@ -64,6 +171,51 @@
 /*============================================================================*/
 /*                               Konstanten                                   */
 /*============================================================================*/
+/*!
+Baudrates tried by option "-B" ("turbo"), in ascending order
+*/
+static const uint32_t g_auiTurboBaudrates[] =
+{
+  230400UL, 460800UL, 921600UL, 1152000UL, 2000000UL
+};
+
+/*!
+Candidates of the baudrate detection ("-b auto"), most common rates first;
+the rate of the last session is probed before
+*/
+static const uint32_t g_auiAutoBaudrates[] =
+{
+  115200UL, 9600UL, 230400UL, 57600UL, 460800UL, 921600UL, 38400UL, 19200UL, 2000000UL, 1152000UL
+};
+
+/*!
+Built-in timeouts of commands with long response times [ms]; all other
+commands use "uiTimeout". A prefix must not be listed behind a shorter prefix
+that matches it (e.g. "AT+CIPSTART" before "AT+CIPSTA").
+*/
+static const timeout_t g_atTimeouts[uiTIMEOUT_ENTRIES] =
+{
+  {"AT+CWJAP",      20000},
+  {"AT+CWLAP",      15000},
+  {"AT+CIPSTART",   10000},
+  {"AT+CIPDOMAIN",  10000},
+  {"AT+PING",       10000},
+  {"AT+CIUPDATE",   60000},
+  {"AT+RST",         5000},
+  {"AT+RESTORE",     5000},
+  {"AT+CIPCLOSE",    5000},
+  {"AT+CWSAP",       5000}
+};
+
+/*!
+Commands that only read data; after a timeout they are sent again (like all
+queries "AT+...?" and tests "AT+...=?"). Other commands may have been executed
+(e.g. "AT+CIPSEND", "AT+RST") and are only repeated after "busy p..."
+*/
+static const char_t* const g_acReadOnly[] =
+{
+  "AT", "AT+GMR", "AT+CWLAP", "AT+CIFSR", "AT+CIPSTATUS"
+};
 
 /*============================================================================*/
 /*                               Variablen                                    */
@@ -100,17 +252,54 @@ void _destruct(void);
 Application local "printf" that handels option "-q" ("quiet") and is able to
 print to stdout/stderr.
 @param pStream Stream to print to ("stdout", "stderr")
-@param acFmt Format string (see "printf")
-@return Errorcode (see "printf"); negative values signaling errors
+@param acFmt Format string (see "espfmt_vprint")
+@return Errorcode (EOK = no error); negative values signaling errors
 */
 int app_printf(FILE* pStream, char_t* acFmt, ...);
 
+/*!
+Application local "fwrite" that handels option "-q" ("quiet"); used to print
+received data without formatting.
+@param pStream Stream to print to ("stdout", "stderr")
+@param pcData Data to print
+@param uiLen Number of characters to print
+@return Errorcode (EOK = no error)
+*/
+int app_write(FILE* pStream, const char_t* pcData, uint16_t uiLen);
+
+/*!
+Receiver of formatted output: write to a stream (see "espfmt_sink_t")
+@param pcData Chunk of the output
+@param uiLen Length of the chunk
+@param pContext Stream ("FILE*")
+*/
+void streamSink(const char_t* pcData, uint16_t uiLen, void* pContext);
+
+/*!
+Receiver of formatted output: write to a file (see "espfmt_sink_t")
+@param pcData Chunk of the output
+@param uiLen Length of the chunk
+@param pContext Handle of the file ("uint8_t*")
+*/
+void fileSink(const char_t* pcData, uint16_t uiLen, void* pContext);
+
 /*!
 This function parses all given commandline arguments/options
 @return Errorcode (EOK = no error)
 */
 int parseArguments(int argc, char* argv[]);
 
+/*!
+Convert the value of an option: the whole text has to be a number within the
+range (no silent truncation by a cast)
+@param acValue Text of the value
+@param uiMin Smallest valid value
+@param uiMax Largest valid value
+@param puiValue Converted value
+@return Errorcode (EOK = no error, EINVAL = no number or out of range)
+*/
+int parseNumber(const char_t* acValue, uint32_t uiMin, uint32_t uiMax, uint32_t* puiValue);
+
 /*!
 Print help of the application
 @return Errorcode (EOK = no error)
@@ -129,342 +318,4121 @@ Execute AT-command
 */
 int command(void);
 
-/*============================================================================*/
-/*                               Klassen                                      */
-/*============================================================================*/
+/*!
+Execute all AT-commands of a script file in one session
+@return Errorcode (EOK = no error)
+*/
+int batch(void);
 
-/*============================================================================*/
-/*                               Implementierung                              */
-/*============================================================================*/
+/*!
+Read AT-commands from the keyboard and execute them in one session ("-i");
+unsolicited messages of the ESP8266 are shown between the commands
+@return Errorcode (EOK = no error)
+*/
+int interactive(void);
 
-/*----------------------------------------------------------------------------*/
-/* _construct()                                                               */
-/*----------------------------------------------------------------------------*/
-void _construct(void)
-{
-  if (!g_tState.bInitialized)
-  {
-    g_tState.eAction    = ACTION_NONE;
-    g_tState.bQuiet     = false;
-    g_tState.uiBaudrate = uiESP_DEFAULT_BAUDRATE;
-    g_tState.uiTimeout  = uiESP_DEFAULT_TIMEOUT;
-    g_tState.acCmd[0]   = '\0';
-    g_tState.uiSpeed    = zxn_getspeed();
-    g_tState.iExitCode  = EOK;
+/*!
+Show the unsolicited messages of the ESP8266 until the data stream pauses
+("uiREPL_SETTLE"); a message without line end is terminated
+*/
+void unsolicited(void);
+
+/*!
+Append a command to the history of the interactive mode; the oldest commands
+are dropped if the history is full
+@param acLine Command
+*/
+void historyAdd(const char_t* acLine);
+
+/*!
+Command of the history of the interactive mode
+@param uiIndex Index of the command (1 = newest)
+@return Command; 0 = no such command
+*/
+const char_t* historyGet(uint8_t uiIndex);
+
+/*!
+Replace the input line of the interactive mode (in "acCmd" and on screen)
+@param acText New content of the line
+@param uiLen Length of the current content
+@return Length of the new content
+*/
+uint8_t editLine(const char_t* acText, uint8_t uiLen);
+
+/*!
+Send a file to a TCP server in chunks of "AT+CIPSEND" ("-u")
+@return Errorcode (EOK = no error)
+*/
+int upload(void);
+
+/*!
+Receive a file from a TCP server in transparent mode ("-d"); with "-p" the
+file is requested by HTTP and the header of the response is skipped
+@return Errorcode (EOK = no error)
+*/
+int download(void);
+
+/*!
+Process one character of the HTTP header of a download
+@param c Received character
+@return true = end of the header
+*/
+bool httpHeader(char_t c);
+
+/*!
+Append received data to the blocks of a download or of the raw copy ("-o")
+@param pcData Received data
+@param uiLen Number of bytes
+@return Errorcode (EOK = no error)
+*/
+int storeData(const char_t* pcData, uint16_t uiLen);
+
+/*!
+Write a block of a download or of the raw copy ("-o") to the file
+@param uiBlock Index of the block (0/1)
+@param uiLen Number of bytes
+@return Errorcode (EOK = no error)
+*/
+int writeBlock(uint8_t uiBlock, uint16_t uiLen);
+
+/*!
+Write the rest of the blocks of a download/raw copy to the file
+@return Errorcode (EOK = no error)
+*/
+int flushBlocks(void);
+
+/*!
+Open the file for the raw copy of the responses ("-o")
+@return Errorcode (EOK = no error)
+*/
+int openCapture(void);
+
+/*!
+Write the rest of the raw copy of the responses and close the file ("-o")
+@return Errorcode (EOK = no error)
+*/
+int closeCapture(void);
+
+/*!
+Copy data to the file of the raw copy ("-o") or of the transcript ("-R");
+only commands and responses of the user are copied
+@param uiType Type of the data ("uiTRANSCRIPT_CMD", "uiTRANSCRIPT_RX")
+@param pcData Data
+@param uiLen Number of bytes
+@return Errorcode (EOK = no error)
+*/
+int rawCopy(uint8_t uiType, const char_t* pcData, uint16_t uiLen);
+
+/*!
+Execute the commands of a transcript ("-P"); the recorded responses are
+processed instead of the data of the UART
+@return Errorcode (EOK = no error)
+*/
+int replay(void);
+
+/*!
+Source of received data while a transcript is replayed (see "espio_source");
+delivers the records of received data up to the next command
+@param pDst Destination buffer
+@param uiSize Size of the destination buffer
+@return Number of bytes (0 = no data available)
+*/
+uint16_t replaySource(uint8_t* pDst, uint16_t uiSize);
+
+/*!
+Read the header of the next record of a transcript, if not read already
+@return Type of the record; 0 = end of the file
+*/
+uint8_t replayNext(void);
+
+/*!
+Read data from the replayed transcript (buffered in the blocks of "xfer")
+@param pDst Destination buffer
+@param uiLen Number of bytes to read
+@return Number of bytes read (less at the end of the file)
+*/
+uint16_t replayRead(uint8_t* pDst, uint16_t uiLen);
+
+/*!
+Receiver of the records of extracted fields ("-e"), see "espkv_open"
+@param pcData Chunk of a record
+@param uiLen Length of the chunk
+@param pContext Not used
+*/
+void exportSink(const char_t* pcData, uint16_t uiLen, void* pContext);
+
+/*!
+Write the buffered records to the file or to the memory of BASIC ("-e")
+@return Errorcode (EOK = no error)
+*/
+int exportWrite(void);
+
+/*!
+Leave the transparent mode of the ESP8266 ("+++")
+*/
+void leaveTransparent(void);
+
+/*!
+Discard all received data for a period of time
+@param uiTime Duration [ms]
+*/
+void discard(uint16_t uiTime);
+
+/*!
+Transmit a string to the ESP8266 as raw data (transparent mode)
+@param acText String to send
+*/
+void sendText(const char_t* acText);
+
+/*!
+Read the next block of the file to upload; missing data (the file shrank) is
+replaced by zeros, because the ESP8266 expects the announced chunk
+@return Errorcode (EOK = no error)
+*/
+int readBlock(void);
+
+/*!
+Calculate a transfer rate
+@param uiBytes Number of transferred bytes
+@param uiTime Duration of the transfer [ms]
+@return Rate [bytes/s]
+*/
+uint32_t transferRate(uint32_t uiBytes, uint32_t uiTime);
+
+/*!
+Open the UART/ESP8266 connection once for a session; while the cached link
+state is valid, the initialization is skipped
+@return Errorcode (EOK = no error)
+*/
+int openSession(void);
+
+/*!
+Initialize the UART/ESP8266 connection (baudrate, timeout, sync)
+@return Errorcode (EOK = no error)
+*/
+int initSession(void);
+
+/*!
+Synchronize the link: send "AT" probes every "uiSYNC_PROBE" and consume the
+input (rests of aborted commands, boot messages, "+IPD") until the "OK" of an
+own probe arrives: an "OK" after the echo of the probe or, without echo
+("ATE0"), after a probe sent into an empty receive buffer. Then the answers
+of the other probes are consumed (within the limit of the sync). An ESP8266
+that answers "busy p..." is alive: the limit is extended to the timeout of
+the commands and the probes are repeated.
+@param uiProbes Number of probes; the sync ends after their periods
+@return Errorcode (EOK = link synchronized)
+*/
+int syncLink(uint8_t uiProbes);
+
+/*!
+Find the baudrate of the ESP8266 ("-b auto"): the rate of the last session
+and the list of common rates are probed until the link can be synchronized;
+each candidate is limited by its probes, the whole detection by
+"uiAUTOBAUD_LIMIT"
+@return Errorcode (EOK = "uiBaudrate" is the rate of the ESP8266)
+*/
+int detectBaudrate(void);
+
+/*!
+Content sink of the sync probe: compare the received line with the echo
+@param pcData Part of the content of the line
+@param uiLen Length of the part
+@param bFirst First part of the line
+*/
+void syncSink(const char_t* pcData, uint16_t uiLen, bool bFirst);
+
+/*!
+Read the timeouts of command prefixes from "acTIMEOUT_FILE" (optional) into
+the link state; the entries of the link state are kept, if the time stamp and
+the size of the file did not change
+@return "EOK" = entries available
+*/
+int loadTimeouts(void);
+
+/*!
+Determine the timeout of a command: "-t", timeout file, built-in table and
+learned response times (in this order)
+@param acCmd Command
+@param puiEntry Entry of the learned response times (0xFF = none)
+@return Timeout [ms]
+*/
+uint16_t commandTimeout(const char_t* acCmd, uint8_t* puiEntry);
+
+/*!
+Update the learned response time of an entry with the longest gap of the
+last response ("rx.uiGap")
+@param uiEntry Entry of the learned response times (0xFF = none)
+*/
+void learnTimeout(uint8_t uiEntry);
+
+/*!
+Read the cached link state from "acLINK_STATE_FILE"; the learned response
+times and the entries of the timeout file are used even if the link state
+itself is outdated
+@return Errorcode (EOK = record read)
+*/
+int loadLinkState(void);
+
+/*!
+Check whether the link state read by "loadLinkState" describes the current
+link: same baudrate, synced within "uiLINK_STATE_VALID" seconds
+@return true = link verified by a previous invocation
+*/
+bool isLinkValid(void);
+
+/*!
+Write the link state to "acLINK_STATE_FILE"
+@return Errorcode (EOK = no error)
+*/
+int saveLinkState(void);
+
+/*!
+Read the firmware version of the ESP8266 ("AT+GMR") into the link state
+@return Errorcode (EOK = no error)
+*/
+int queryFirmware(void);
+
+/*!
+Send one AT-command to the ESP8266 and wait for the final response
+@param acCmd AT-command to send (without CR/LF)
+@return Errorcode (EOK = no error)
+*/
+int execute(const char_t* acCmd);
+
+/*!
+Check whether a command only reads data, so that it can be sent again after a
+timeout without side effects
+@param acCmd AT-command (without CR/LF)
+@return true = read only
+*/
+bool isReadOnly(const char_t* acCmd);
+
+/*!
+Wait with exponential backoff until the ESP8266 answers an "AT" probe; each
+probe counts as one retry ("-r")
+@param puiBackoff Backoff of the next retry [ms]; doubled by each retry
+@return Errorcode (EOK = ESP8266 ready, the command can be sent again)
+*/
+int resync(uint16_t* puiBackoff);
+
+/*!
+Send one AT-command to the ESP8266 without any output (e.g. configuration)
+@param acCmd AT-command to send (without CR/LF)
+@param uiTimeout Timeout [ms]
+@return Errorcode (EOK = no error)
+*/
+int request(const char_t* acCmd, uint16_t uiTimeout);
+
+/*!
+Send one AT-command to the ESP8266 and process the response until the final
+response ("OK", "ERROR", "FAIL") or a timeout
+@param acCmd AT-command to send (without CR/LF)
+@param uiTimeout Timeout [ms]
+@return Errorcode (EOK = no error)
+*/
+int transact(const char_t* acCmd, uint16_t uiTimeout);
+
+/*!
+Wait (without output) for the final response of a command that ended early
+on a pattern ("-w", "-x")
+@param uiTimeout Timeout [ms]
+*/
+void awaitOutstanding(uint16_t uiTimeout);
+
+/*!
+Process the response of the ESP8266 until the final response ("OK",
+"ERROR", "FAIL", "SEND OK", ...), the data prompt or a timeout
+@param uiTimeout Timeout [ms]
+@return Errorcode (EOK = no error)
+*/
+int awaitResponse(uint16_t uiTimeout);
+
+/*!
+Process a response captured in the pages of memory ("-M"): output and
+patterns ("-w", "-x")
+@param iResult Result of the reception
+@return Errorcode (EOK = no error)
+*/
+int replayResponse(int iResult);
+
+/*!
+Render queued output to the console (the time is recorded with "-T")
+@param bAll true = all output; false = one quantum (ESP8266 idle)
+*/
+void render(bool bAll);
+
+/*!
+Print/log the timing record of a command ("-T", "-L")
+@param acCmd Executed command
+@param iResult Result of the command
+*/
+void recordTiming(const char_t* acCmd, int iResult);
+
+/*!
+Output of received data (suppressed for internal requests)
+@param pcData Data to print
+@param uiLen Number of characters to print
+*/
+void output(const char_t* pcData, uint16_t uiLen);
+
+/*!
+A final response was received: the link is in a known good state
+*/
+void syncLinkState(void);
+
+/*!
+Capture the rest of the first line of received data that starts with a given
+prefix (internal requests, see "appstate_t.rx.pcCapture")
+@param pcData Data to capture
+@param uiLen Number of characters
+*/
+void capture(const char_t* pcData, uint16_t uiLen);
+
+/*!
+Raise the baudrate of the ESP8266 and the UART ("turbo") to the highest rate
+that passes a verification probe
+@return Errorcode (EOK = no error)
+*/
+int enableTurbo(void);
+
+/*!
+Set the baudrate of the ESP8266 ("AT+UART_CUR") and the UART
+@param uiBaudrate Baudrate [bit/s]
+@return Errorcode (EOK = no error); the UART is switched in any case
+*/
+int setEspBaudrate(uint32_t uiBaudrate);
+
+/*!
+Restore the baudrate of the ESP8266 and the UART after "enableTurbo"
+@return Errorcode (EOK = no error)
+*/
+int disableTurbo(void);
+
+/*!
+Enable the hardware flow control (RTS/CTS) of the ESP8266 and the UART ("-F");
+without an answer to the verification probe both sides return to no flow
+control
+@return Errorcode (EOK = no error)
+*/
+int enableFlow(void);
+
+/*!
+Disable the hardware flow control after "enableFlow"
+@return Errorcode (EOK = no error)
+*/
+int disableFlow(void);
+
+/*!
+Receiver of the content of printable lines (see "esptok_sink_t")
+@param pcData Chunk of the line
+@param uiLen Length of the chunk
+@param bFirst true = first chunk of the line
+*/
+void content(const char_t* pcData, uint16_t uiLen, bool bFirst);
+
+/*!
+Decide at the end of a line whether the held line is shown or dropped
+("-g", "-G", "-n")
+*/
+void filterLine(void);
+
+/*!
+Read the next line from the opened script file
+@param acLine Buffer for the line (without CR/LF)
+@param uiSize Size of the buffer
+@return Length of the line; iLINE_EOF, iLINE_ERROR or iLINE_TOO_LONG
+*/
+int readLine(char_t* acLine, uint8_t uiSize);
+
+/*============================================================================*/
+/*                               Klassen                                      */
+/*============================================================================*/
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* _construct()                                                               */
+/*----------------------------------------------------------------------------*/
+void _construct(void)
+{
+  if (!g_tState.bInitialized)
+  {
+    g_tState.eAction    = ACTION_NONE;
+    g_tState.bQuiet     = false;
+    g_tState.uiBaudrate = uiESP_DEFAULT_BAUDRATE;
+    g_tState.bAutoBaud  = false;
+    g_tState.uiTimeout  = uiESP_DEFAULT_TIMEOUT;
+    g_tState.timeout.bFixed = false;
+    g_tState.retry.uiMax  = 0;
+    g_tState.retry.uiUsed = 0;
+    g_tState.filter.bInclude = false;
+    g_tState.filter.bExclude = false;
+    g_tState.filter.uiMax    = 0;
+    g_tState.filter.uiLines  = 0;
+    g_tState.filter.bHeld    = false;
+    g_tState.pcCmd      = 0;
+    g_tState.acCmd[0]   = '\0';
+    g_tState.pcFile     = 0;
+    g_tState.bContinue  = false;
+    g_tState.bInteractive = false;
+    g_tState.batch.hFile = 0xFF;
+    g_tState.pcXferFile = 0;
+    g_tState.pcServer   = 0;
+    g_tState.pcPath     = 0;
+    g_tState.bDownload  = false;
+    g_tState.pcRawFile  = 0;
+    g_tState.bAppend    = false;
+    g_tState.transcript.bRecord = false;
+    g_tState.transcript.pcFile  = 0;
+    g_tState.transcript.bFast   = false;
+    g_tState.export.pcFile    = 0;
+    g_tState.export.uiAddress = 0;
+    g_tState.export.uiEnd     = 0;
+    g_tState.export.bStarted  = false;
+    g_tState.export.uiFill    = 0;
+    g_tState.timing.bEnabled = false;
+    g_tState.timing.bPrint   = false;
+    g_tState.timing.pcLog    = 0;
+    g_tState.timing.uiSetup  = 0;
+    g_tState.uiPort     = 0;
+    g_tState.xfer.hFile = 0xFF;
+    g_tState.bTurbo     = false;
+    g_tState.uiTurboBaudrate = 0;
+    g_tState.bFlow      = false;
+    g_tState.bFlowActive = false;
+    g_tState.bIrq       = false;
+    g_tState.uiPages    = 0;
+    g_tState.link.bCached = false;
+    g_tState.link.bSynced = false;
+    g_tState.link.bDirty  = false;
+    memset(&g_tState.link.tState, 0, sizeof(g_tState.link.tState));
+    g_tState.rx.pcCapture = 0;
+    g_tState.rx.uiMatch   = 0;
+    g_tState.rx.uiTags    = 0;
+    g_tState.rx.bOutstanding = false;
+    g_tState.rx.bBusy     = false;
+    g_tState.rx.bBanked   = false;
+    g_tState.uiSpeed    = zxn_getspeed();
+    g_tState.iExitCode  = EOK;
+
+    espmatch_reset();
+
+    zxn_setspeed(RTM_28MHZ);
+    esp_open(&g_tState.tEsp);
+
+    g_tState.bInitialized = true;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* _destruct()                                                                */
+/*----------------------------------------------------------------------------*/
+void _destruct(void)
+{
+  if (g_tState.bInitialized)
+  {
+    espio_irq(false);
+    espbank_close();
+    closeCapture();
+
+    if (0xFF != g_tState.batch.hFile)
+    {
+      esx_f_close(g_tState.batch.hFile);
+      g_tState.batch.hFile = 0xFF;
+    }
+
+    if (0xFF != g_tState.xfer.hFile)
+    {
+      esx_f_close(g_tState.xfer.hFile);
+      g_tState.xfer.hFile = 0xFF;
+    }
+
+    /* Both ends return to the session settings, even on errors/timeouts */
+    disableFlow();
+    disableTurbo();
+
+    /* A replay does not know the state of the link */
+    if (g_tState.link.bDirty && (ACTION_REPLAY != g_tState.eAction))
+    {
+      saveLinkState();
+    }
+
+    esp_close(&g_tState.tEsp);
+    zxn_setspeed(g_tState.uiSpeed);
+
+    /* The only output of the trace: nothing is formatted while receiving */
+    ESPTRACE_DUMP();
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* main()                                                                     */
+/*----------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+  _construct();
+  atexit(_destruct);
+
+  if (EOK == (g_tState.iExitCode = parseArguments(argc, argv)))
+  {
+    /* Only the actions from ACTION_COMMAND on talk to the ESP8266; before
+       any file is opened, the buffer of the script file is reused */
+    if (ACTION_COMMAND <= g_tState.eAction)
+    {
+      /* A replay does not know the state of the link */
+      if (ACTION_REPLAY != g_tState.eAction)
+      {
+        loadLinkState();
+      }
+
+      if (!g_tState.timeout.bFixed)
+      {
+        loadTimeouts();
+      }
+    }
+
+    switch (g_tState.eAction)
+    {
+      case ACTION_NONE:
+        g_tState.iExitCode = EOK;
+        break;
+
+      case ACTION_HELP:
+        g_tState.iExitCode = showHelp();
+        break;
+
+      case ACTION_INFO:
+        g_tState.iExitCode = showInfo();
+        break;
+
+      case ACTION_COMMAND:
+        g_tState.iExitCode = command();
+        break;
+
+      case ACTION_BATCH:
+        g_tState.iExitCode = batch();
+        break;
+
+      case ACTION_UPLOAD:
+        g_tState.iExitCode = upload();
+        break;
+
+      case ACTION_DOWNLOAD:
+        g_tState.iExitCode = download();
+        break;
+
+      case ACTION_INTERACTIVE:
+        g_tState.iExitCode = interactive();
+        break;
+
+      case ACTION_REPLAY:
+        g_tState.iExitCode = replay();
+        break;
+    }
+  }
+
+  return (int) (EOK == g_tState.iExitCode ? 0 : zxn_strerror(g_tState.iExitCode));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* app_printf()                                                               */
+/*----------------------------------------------------------------------------*/
+int app_printf(FILE* pStream, char_t* acFmt, ...)
+{
+  int iReturn = EOK;
+
+  if (pStream && acFmt) 
+  {
+    if (!g_tState.bQuiet)
+    {
+      va_list args;
+      va_start(args, acFmt);
+
+      espfmt_vprint(streamSink, pStream, acFmt, args);
+
+      va_end(args);
+    }
+  }
+  else
+  {
+    iReturn = -EINVAL;
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* app_write()                                                                */
+/*----------------------------------------------------------------------------*/
+int app_write(FILE* pStream, const char_t* pcData, uint16_t uiLen)
+{
+  if (!pStream || !pcData)
+  {
+    return EINVAL;
+  }
+
+  if (!g_tState.bQuiet && uiLen)
+  {
+    fwrite(pcData, 1, uiLen, pStream);
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* streamSink()                                                               */
+/*----------------------------------------------------------------------------*/
+void streamSink(const char_t* pcData, uint16_t uiLen, void* pContext)
+{
+  fwrite(pcData, 1, uiLen, (FILE*) pContext);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* fileSink()                                                                 */
+/*----------------------------------------------------------------------------*/
+void fileSink(const char_t* pcData, uint16_t uiLen, void* pContext)
+{
+  esx_f_write(*(uint8_t*) pContext, pcData, uiLen);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* parseArguments()                                                           */
+/*----------------------------------------------------------------------------*/
+int parseArguments(int argc, char* argv[])
+{
+  int iReturn = EOK;
+  char_t* pcRecord = 0;
+
+  /* Defaults */
+  g_tState.eAction = ACTION_NONE;
+
+  int i = 1;
+  while (i < argc)
+  {
+    const char_t* acArg = argv[i];
+
+    if ('-' == acArg[0]) /* Options */
+    {
+      if ((0 == strcmp(acArg, "-h")) || (0 == stricmp(acArg, "--help")))
+      {
+        g_tState.eAction = ACTION_HELP;
+      }
+      else if ((0 == strcmp(acArg, "-v")) || (0 == stricmp(acArg, "--version")))
+      {
+        g_tState.eAction = ACTION_INFO;
+      }
+      else if ((0 == strcmp(acArg, "-q")) || (0 == stricmp(acArg, "--quiet")))
+      {
+        g_tState.bQuiet = true;
+      }
+      else if ((0 == strcmp(acArg, "-b")) || (0 == stricmp(acArg, "--baudrate")))
+      {
+        if ((i + 1) < argc)
+        {
+          if (0 == stricmp(argv[++i], "auto"))
+          {
+            g_tState.bAutoBaud = true;
+          }
+          else if (EOK != parseNumber(argv[i], uiMIN_BAUDRATE, uiMAX_BAUDRATE, &g_tState.uiBaudrate))
+          {
+            app_printf(stderr, "invalid value: %s\n", argv[i]);
+            iReturn = EINVAL;
+            break;
+          }
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-B")) || (0 == stricmp(acArg, "--turbo")))
+      {
+        g_tState.bTurbo = true;
+      }
+      else if ((0 == strcmp(acArg, "-F")) || (0 == stricmp(acArg, "--flow")))
+      {
+        g_tState.bFlow = true;
+      }
+      else if ((0 == strcmp(acArg, "-w")) || (0 == stricmp(acArg, "--wait")) ||
+               (0 == strcmp(acArg, "-x")) || (0 == stricmp(acArg, "--fail")))
+      {
+        uint8_t uiTag = ((0 == strcmp(acArg, "-w")) || (0 == stricmp(acArg, "--wait"))) ?
+                        uiEXPECT_SUCCESS : uiEXPECT_FAILURE;
+
+        if ((i + 1) < argc)
+        {
+          if (EOK != espmatch_add(argv[++i], uiTag))
+          {
+            app_printf(stderr, "invalid pattern: %s\n", argv[i]);
+            iReturn = EINVAL;
+            break;
+          }
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-g")) || (0 == stricmp(acArg, "--grep")) ||
+               (0 == strcmp(acArg, "-G")) || (0 == stricmp(acArg, "--skip")))
+      {
+        bool bInclude = (0 == strcmp(acArg, "-g")) || (0 == stricmp(acArg, "--grep"));
+
+        if ((i + 1) < argc)
+        {
+          if (EOK != espmatch_add(argv[++i], bInclude ? uiFILTER_INCLUDE : uiFILTER_EXCLUDE))
+          {
+            app_printf(stderr, "invalid pattern: %s\n", argv[i]);
+            iReturn = EINVAL;
+            break;
+          }
+
+          if (bInclude)
+          {
+            g_tState.filter.bInclude = true;
+          }
+          else
+          {
+            g_tState.filter.bExclude = true;
+          }
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-n")) || (0 == stricmp(acArg, "--max")))
+      {
+        if ((i + 1) < argc)
+        {
+          uint32_t uiMax;
+
+          if (EOK != parseNumber(argv[++i], 1, 0xFFFF, &uiMax))
+          {
+          app_printf(stderr, "invalid value: %s\n", argv[i]);
+          iReturn = EINVAL;
+          break;
+          }
+
+          g_tState.filter.uiMax = (uint16_t) uiMax;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-T")) || (0 == stricmp(acArg, "--timing")))
+      {
+        g_tState.timing.bEnabled = true;
+        g_tState.timing.bPrint   = true;
+      }
+      else if ((0 == strcmp(acArg, "-L")) || (0 == stricmp(acArg, "--log")))
+      {
+        if ((i + 1) < argc)
+        {
+          g_tState.timing.pcLog = argv[++i];
+          g_tState.timing.bEnabled = true;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-I")) || (0 == stricmp(acArg, "--irq")))
+      {
+        g_tState.bIrq = true;
+      }
+      else if ((0 == strcmp(acArg, "-i")) || (0 == stricmp(acArg, "--interact")))
+      {
+        g_tState.bInteractive = true;
+      }
+      else if ((0 == strcmp(acArg, "-o")) || (0 == stricmp(acArg, "--output")))
+      {
+        if ((i + 1) < argc)
+        {
+          g_tState.pcRawFile = argv[++i];
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-a")) || (0 == stricmp(acArg, "--append")))
+      {
+        g_tState.bAppend = true;
+      }
+      else if ((0 == strcmp(acArg, "-R")) || (0 == stricmp(acArg, "--record")))
+      {
+        if ((i + 1) < argc)
+        {
+          pcRecord = argv[++i];
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-P")) || (0 == stricmp(acArg, "--play")))
+      {
+        if ((i + 1) < argc)
+        {
+          g_tState.transcript.pcFile = argv[++i];
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-e")) || (0 == stricmp(acArg, "--export")))
+      {
+        if ((i + 1) < argc)
+        {
+          /* "@address": memory of BASIC, otherwise a file */
+          if ('@' == argv[++i][0])
+          {
+            uint32_t uiAddress;
+
+            /* Free memory of BASIC only (not the program, stack, IM2 table) */
+            if (EOK != parseNumber(&argv[i][1], (uint32_t) espuart_ramtop() + 1, uiEXPORT_END_ADDRESS - 1, &uiAddress))
+            {
+              app_printf(stderr, "invalid value: %s\n", argv[i]);
+              iReturn = EINVAL;
+              break;
+            }
+
+            g_tState.export.uiAddress = (uint16_t) uiAddress;
+            g_tState.export.uiEnd     = (uiEXPORT_END_ADDRESS - uiAddress > uiEXPORT_MAX_SIZE) ?
+                                        (uint16_t) (uiAddress + uiEXPORT_MAX_SIZE) : uiEXPORT_END_ADDRESS;
+          }
+          else
+          {
+            g_tState.export.pcFile = argv[i];
+          }
+
+          espkv_open(exportSink, 0);
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-z")) || (0 == stricmp(acArg, "--fast")))
+      {
+        g_tState.transcript.bFast = true;
+      }
+      else if ((0 == strcmp(acArg, "-M")) || (0 == stricmp(acArg, "--mem")))
+      {
+        if ((i + 1) < argc)
+        {
+          uint32_t uiPages;
+
+          if (EOK != parseNumber(argv[++i], 1, uiESPBANK_MAX_PAGES, &uiPages))
+          {
+            app_printf(stderr, "invalid value: %s\n", argv[i]);
+            iReturn = EINVAL;
+            break;
+          }
+
+          g_tState.uiPages = (uint8_t) uiPages;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-t")) || (0 == stricmp(acArg, "--timeout")))
+      {
+        if ((i + 1) < argc)
+        {
+          uint32_t uiTimeout;
+
+          if (EOK != parseNumber(argv[++i], 1, 0xFFFF, &uiTimeout))
+          {
+          app_printf(stderr, "invalid value: %s\n", argv[i]);
+          iReturn = EINVAL;
+          break;
+          }
+
+          g_tState.uiTimeout = (uint16_t) uiTimeout;
+          g_tState.timeout.bFixed = true;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-r")) || (0 == stricmp(acArg, "--retry")))
+      {
+        if ((i + 1) < argc)
+        {
+          uint32_t uiRetries;
+
+          if (EOK != parseNumber(argv[++i], 0, 0xFF, &uiRetries))
+          {
+          app_printf(stderr, "invalid value: %s\n", argv[i]);
+          iReturn = EINVAL;
+          break;
+          }
+
+          g_tState.retry.uiMax = (uint8_t) uiRetries;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-f")) || (0 == stricmp(acArg, "--file")))
+      {
+        if ((i + 1) < argc)
+        {
+          g_tState.pcFile = argv[++i];
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-u")) || (0 == stricmp(acArg, "--upload")))
+      {
+        if (g_tState.pcXferFile)
+        {
+          app_printf(stderr, "only one transfer (-u/-d)\n");
+          iReturn = EINVAL;
+          break;
+        }
+        else if ((i + 1) < argc)
+        {
+          g_tState.pcXferFile = argv[++i];
+          g_tState.bDownload = false;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-d")) || (0 == stricmp(acArg, "--down")))
+      {
+        if (g_tState.pcXferFile)
+        {
+          app_printf(stderr, "only one transfer (-u/-d)\n");
+          iReturn = EINVAL;
+          break;
+        }
+        else if ((i + 1) < argc)
+        {
+          g_tState.pcXferFile = argv[++i];
+          g_tState.bDownload = true;
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-p")) || (0 == stricmp(acArg, "--path")))
+      {
+        if ((i + 1) < argc)
+        {
+          g_tState.pcPath = argv[++i];
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-s")) || (0 == stricmp(acArg, "--server")))
+      {
+        if ((i + 1) < argc)
+        {
+          char_t* pcPort;
+          uint32_t uiPort;
+
+          g_tState.pcServer = argv[++i];
+
+          /* "host:port" */
+          if ((0 == (pcPort = strrchr(g_tState.pcServer, ':'))) ||
+              (EOK != parseNumber(pcPort + 1, 1, 0xFFFF, &uiPort)))
+          {
+            app_printf(stderr, "invalid server: %s\n", argv[i]);
+            iReturn = EINVAL;
+            break;
+          }
+
+          g_tState.uiPort = (uint16_t) uiPort;
+          *pcPort = '\0';
+        }
+        else
+        {
+          app_printf(stderr, "option %s requires a value\n", acArg);
+          iReturn = EINVAL;
+          break;
+        }
+      }
+      else if ((0 == strcmp(acArg, "-c")) || (0 == stricmp(acArg, "--continue")))
+      {
+        g_tState.bContinue = true;
+      }
+      else
+      {
+        app_printf(stderr, "unknown option: %s\n", acArg);
+        iReturn = EINVAL;
+        break;
+      }
+    }
+    else /* Arguments */
+    {
+      if (!g_tState.pcCmd)
+      {
+        g_tState.pcCmd = acArg;
+      }
+      else
+      {
+        app_printf(stderr, "unexpected argument: %s\n", acArg);
+        iReturn = EINVAL;
+        break;
+      }
+    }
+
+    ++i;
+  }
+
+  if (EOK == iReturn)
+  {
+    /* Both write the same file ("pcRawFile") */
+    if (g_tState.pcRawFile && pcRecord)
+    {
+      app_printf(stderr, "options -o and -R are exclusive\n");
+      iReturn = EINVAL;
+    }
+    else if (pcRecord)
+    {
+      g_tState.pcRawFile = pcRecord;
+      g_tState.transcript.bRecord = true;
+    }
+  }
+
+  if (EOK == iReturn)
+  {
+    if (ACTION_NONE == g_tState.eAction)
+    {
+      if (1 < ((0 != g_tState.pcCmd) + (0 != g_tState.pcFile) + (0 != g_tState.pcXferFile) +
+               (0 != g_tState.transcript.pcFile) + g_tState.bInteractive))
+      {
+        app_printf(stderr, "command, script and transfer are exclusive\n");
+        iReturn = EINVAL;
+      }
+      else if ((g_tState.pcXferFile || g_tState.transcript.pcFile) && g_tState.pcRawFile)
+      {
+        /* All of them use the blocks of "xfer" */
+        app_printf(stderr, "transfer, replay and output are exclusive\n");
+        iReturn = EINVAL;
+      }
+      else if (g_tState.pcFile)
+      {
+        g_tState.eAction = ACTION_BATCH;
+      }
+      else if (g_tState.pcXferFile)
+      {
+        if (g_tState.pcServer)
+        {
+          g_tState.eAction = g_tState.bDownload ? ACTION_DOWNLOAD : ACTION_UPLOAD;
+        }
+        else
+        {
+          app_printf(stderr, "no server specified\n");
+          iReturn = EINVAL;
+        }
+      }
+      else if (g_tState.bInteractive)
+      {
+        g_tState.eAction = ACTION_INTERACTIVE;
+      }
+      else if (g_tState.transcript.pcFile)
+      {
+        g_tState.eAction = ACTION_REPLAY;
+      }
+      else if (g_tState.pcCmd)
+      {
+        g_tState.eAction = ACTION_COMMAND;
+      }
+      else
+      {
+        app_printf(stderr, "no command specified\n");
+        iReturn = EINVAL;
+      }
+    }
+  }
+
+  DBGPRINTF("parseargs() - action   = %d\n", g_tState.eAction);
+  DBGPRINTF("parseargs() - command  = %s\n", g_tState.pcCmd ? g_tState.pcCmd : "");
+  DBGPRINTF("parseargs() - file     = %s\n", g_tState.pcFile ? g_tState.pcFile : "");
+  DBGPRINTF("parseargs() - baudrate = %lu\n", (unsigned long) g_tState.uiBaudrate);
+  DBGPRINTF("parseargs() - timeout  = %u\n", g_tState.uiTimeout);
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* parseNumber()                                                              */
+/*----------------------------------------------------------------------------*/
+int parseNumber(const char_t* acValue, uint32_t uiMin, uint32_t uiMax, uint32_t* puiValue)
+{
+  char_t* pcEnd;
+  unsigned long uiValue;
+
+  /* strtoul() accepts a sign: "-1" would become the largest number */
+  if (('\0' == *acValue) || ('-' == *acValue) || ('+' == *acValue))
+  {
+    return EINVAL;
+  }
+
+  uiValue = strtoul(acValue, &pcEnd, 0);
+
+  if (('\0' != *pcEnd) || (uiMin > uiValue) || (uiMax < uiValue))
+  {
+    return EINVAL;
+  }
+
+  *puiValue = (uint32_t) uiValue;
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* showHelp()                                                                 */
+/*----------------------------------------------------------------------------*/
+int showHelp(void)
+{
+  char_t acAppName[0x10];
+  strncpy(acAppName, VER_INTERNALNAME_STR, sizeof(acAppName));
+  strupr(acAppName);
+
+  app_printf(stdout, "%s\n\n", VER_FILEDESCRIPTION_STR);
+
+  app_printf(stdout, "%s cmd|-i|-f x|-u x|-d x\n"
+                     "  [-s x][-p x][-c][-r x][-b x]\n"
+                     "  [-B][-F][-w x][-x x][-T][-L x]\n"
+                     "  [-t x][-I][-M x][-o x][-a]\n"
+                     "  [-R x][-P x][-z][-e x]\n"
+                     "  [-g x][-G x][-n x]\n"
+                     "  [-q][-h|-v]\n\n", acAppName);
+  //                  0.........1.........2.........3.
+  app_printf(stdout, " cmd         command to execute\n");
+  app_printf(stdout, " -i[nteract] command prompt\n");
+  app_printf(stdout, " -f[ile]     script to execute\n");
+  app_printf(stdout, " -c[ontinue] ignore script errors\n");
+  app_printf(stdout, " -r[etry] x  retry busy/timeout\n");
+  app_printf(stdout, " -u[pload] x file to send (TCP)\n");
+  app_printf(stdout, " -d/--down x file to receive\n");
+  app_printf(stdout, " -p[ath] x   HTTP path (-d)\n");
+  app_printf(stdout, " -s[erver] x host:port (-u/-d)\n");
+  app_printf(stdout, " -b[audrate] bit/s or \"auto\"\n");
+  app_printf(stdout, " -B/--turbo  max. baudrate\n");
+  app_printf(stdout, " -F/--flow   RTS/CTS handshake\n");
+  app_printf(stdout, " -I/--irq    frame IRQ <=230400\n");
+  app_printf(stdout, "             (higher only w/ -F)\n");
+  app_printf(stdout, " -M/--mem x  capture in x*8K RAM\n");
+  app_printf(stdout, " -o[utput] x raw copy to file\n");
+  app_printf(stdout, " -a[ppend]   append to file (-o)\n");
+  app_printf(stdout, " -R[ecord] x transcript to file\n");
+  app_printf(stdout, " -P/--play x replay transcript\n");
+  app_printf(stdout, " -z/--fast   replay w/o delays\n");
+  app_printf(stdout, " -e[xport] x key=value to x/@adr\n");
+  app_printf(stdout, " -w/--wait x OK on line with x\n");
+  app_printf(stdout, " -x/--fail x error on line with x\n");
+  app_printf(stdout, " -g/--grep x show lines with x\n");
+  app_printf(stdout, " -G/--skip x hide lines with x\n");
+  app_printf(stdout, " -n/--max x  max. lines shown\n");
+  app_printf(stdout, " -T/--timing print timing record\n");
+  app_printf(stdout, " -L[og] x    append timing to CSV\n");
+  app_printf(stdout, " -t[imeout]  timeout in [ms]\n");
+  app_printf(stdout, " -q[uiet]    no screen output\n");
+  app_printf(stdout, " -h[elp]     print this help\n");
+  app_printf(stdout, " -v[ersion]  print version info\n");
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* showInfo()                                                                 */
+/*----------------------------------------------------------------------------*/
+int showInfo(void)
+{
+  char_t acBuffer[0x10];
+  uint16_t uiVersion;
+
+  strncpy(acBuffer, VER_INTERNALNAME_STR, sizeof(acBuffer));
+  strupr(acBuffer);
+
+  app_printf(stdout, "%s " VER_LEGALCOPYRIGHT_STR "\n", acBuffer);
+
+  if (ESX_DOSVERSION_NEXTOS_48K != (uiVersion = esx_m_dosversion()))
+  {
+    espfmt_format(acBuffer, sizeof(acBuffer), "NextOS %u.%02u",
+                  ESX_DOSVERSION_NEXTOS_MAJOR(uiVersion),
+                  ESX_DOSVERSION_NEXTOS_MINOR(uiVersion));
+  }
+  else
+  {
+    strncpy(acBuffer, "48K mode", sizeof(acBuffer));
+  }
+
+  //                  0.........1.........2.........3.
+  app_printf(stdout, " Version %s (%s)\n", VER_FILEVERSION_STR, acBuffer);
+  app_printf(stdout, " Stefan Zell (info@diezells.de)\n");
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* command()                                                                  */
+/*----------------------------------------------------------------------------*/
+int command(void)
+{
+  int iReturn;
+  int iResult;
+
+  if ((EOK == (iReturn = openCapture())) && (EOK == (iReturn = openSession())))
+  {
+    iReturn = execute(g_tState.pcCmd);
+  }
+
+  /* Errors of the command take precedence */
+  iResult = closeCapture();
+
+  return (EOK != iReturn) ? iReturn : iResult;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* batch()                                                                    */
+/*----------------------------------------------------------------------------*/
+int batch(void)
+{
+  int iReturn = EOK;
+  int iResult;
+  uint16_t uiLine = 0;
+  bool bIgnore;
+  char_t* pcCmd;
+
+  g_tState.batch.uiFill = 0;
+  g_tState.batch.uiPos  = 0;
+
+  if (0xFF == (g_tState.batch.hFile = esx_f_open(g_tState.pcFile, ESX_MODE_READ | ESX_MODE_OPEN_EXIST)))
+  {
+    app_printf(stderr, "cannot open %s\n", g_tState.pcFile);
+    iReturn = EBADF;
+    goto EXIT_BATCH;
+  }
+
+  /* Initialize UART / ESP8266 once for the whole script */
+  if ((EOK != (iReturn = openCapture())) || (EOK != (iReturn = openSession())))
+  {
+    goto EXIT_BATCH;
+  }
+
+  while (iLINE_EOF != (iResult = readLine(g_tState.acCmd, sizeof(g_tState.acCmd))))
+  {
+    ++uiLine;
+
+    if (iLINE_ERROR == iResult)
+    {
+      app_printf(stderr, "cannot read %s\n", g_tState.pcFile);
+      iReturn = EBADF;
+      break;
+    }
+
+    /* A truncated command is never sent */
+    if (iLINE_TOO_LONG == iResult)
+    {
+      app_printf(stderr, "line %u: too long\n", uiLine);
+
+      if (EOK == iReturn)
+      {
+        iReturn = EINVAL;
+      }
+
+      if (!g_tState.bContinue)
+      {
+        break;
+      }
+
+      continue;
+    }
+
+    /* Skip leading whitespace */
+    pcCmd = g_tState.acCmd;
+    while ((' ' == *pcCmd) || ('\t' == *pcCmd))
+    {
+      ++pcCmd;
+    }
+
+    /* Skip empty lines and comments */
+    if (('\0' == *pcCmd) || ('#' == *pcCmd) || (';' == *pcCmd))
+    {
+      continue;
+    }
+
+    /* Per-line policy: a leading '-' ignores all errors of this line */
+    if ((bIgnore = ('-' == *pcCmd)))
+    {
+      ++pcCmd;
+    }
+
+    if (EOK != (iResult = execute(pcCmd)))
+    {
+      app_printf(stderr, "line %u: error %d\n", uiLine, iResult);
+
+      if (!bIgnore)
+      {
+        /* The first error determines the exitcode of the script */
+        if (EOK == iReturn)
+        {
+          iReturn = iResult;
+        }
+
+        if (!g_tState.bContinue)
+        {
+          break;
+        }
+      }
+    }
+  }
+
+EXIT_BATCH:
+
+  if (0xFF != g_tState.batch.hFile)
+  {
+    esx_f_close(g_tState.batch.hFile);
+    g_tState.batch.hFile = 0xFF;
+  }
+
+  /* Errors of the script take precedence */
+  iResult = closeCapture();
+
+  return (EOK != iReturn) ? iReturn : iResult;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* interactive()                                                              */
+/*----------------------------------------------------------------------------*/
+int interactive(void)
+{
+  char_t* acLine = g_tState.acCmd;
+  const char_t* pcData;
+  const char_t* pcEntry;
+  uint8_t uiLen = 0;
+  uint8_t uiKey;
+  bool bPrompt  = false;
+  int iReturn;
+  int iResult;
+
+  g_tState.repl.uiUsed  = 0;
+  g_tState.repl.uiCount = 0;
+  g_tState.repl.uiShown = 0;
+
+  if ((EOK == (iReturn = openCapture())) && (EOK == (iReturn = openSession())))
+  {
+    acLine[0] = '\0';
+    esptok_reset(content);
+
+    for ( ; ; )
+    {
+      /* Unsolicited messages ("WIFI GOT IP", "+IPD", ...) below the prompt */
+      if (0 != espio_span(&pcData))
+      {
+        if (bPrompt)
+        {
+          app_printf(stdout, "\n");
+          bPrompt = false;
+        }
+
+        unsolicited();
+        continue;
+      }
+
+      if (!bPrompt)
+      {
+        app_printf(stdout, "> %s", acLine);
+        fflush(stdout);
+        bPrompt = true;
+      }
+
+      if (0 == (uiKey = espuart_key()))
+      {
+        continue;
+      }
+
+      if (uiESPUART_KEY_END == uiKey)
+      {
+        break;
+      }
+
+      if (uiESPUART_KEY_ENTER == uiKey)
+      {
+        app_printf(stdout, "\n");
+        bPrompt = false;
+
+        if (0 == stricmp(acLine, "exit"))
+        {
+          break;
+        }
+
+        if (uiLen)
+        {
+          historyAdd(acLine);
+
+          if (EOK != (iResult = execute(acLine)))
+          {
+            fflush(stdout);
+            app_printf(stderr, "error %d\n", iResult);
+          }
+
+          /* The rest of the response is no unsolicited message */
+          awaitOutstanding(g_tState.uiTimeout);
+          esptok_reset(content);
+        }
+
+        acLine[0] = '\0';
+        uiLen = 0;
+        g_tState.repl.uiShown = 0;
+      }
+      else if (uiESPUART_KEY_DELETE == uiKey)
+      {
+        if (uiLen)
+        {
+          acLine[--uiLen] = '\0';
+          app_printf(stdout, "\b \b");
+        }
+      }
+      else if ((uiESPUART_KEY_UP == uiKey) || (uiESPUART_KEY_DOWN == uiKey))
+      {
+        if ((uiESPUART_KEY_UP == uiKey) && (g_tState.repl.uiShown < g_tState.repl.uiCount))
+        {
+          ++g_tState.repl.uiShown;
+        }
+        else if ((uiESPUART_KEY_DOWN == uiKey) && (0 < g_tState.repl.uiShown))
+        {
+          --g_tState.repl.uiShown;
+        }
+
+        pcEntry = historyGet(g_tState.repl.uiShown);
+        uiLen   = editLine(pcEntry ? pcEntry : "", uiLen);
+      }
+      else if ((' ' <= uiKey) && (0x7F > uiKey) && ((uiMAX_LEN_CMD - 1) > uiLen))
+      {
+        acLine[uiLen++] = (char_t) uiKey;
+        acLine[uiLen]   = '\0';
+        app_printf(stdout, "%c", uiKey);
+      }
+
+      fflush(stdout);
+    }
+  }
+
+  /* Errors of the session take precedence */
+  iResult = closeCapture();
+
+  return (EOK != iReturn) ? iReturn : iResult;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* unsolicited()                                                              */
+/*----------------------------------------------------------------------------*/
+void unsolicited(void)
+{
+  const char_t* pcData;
+  uint16_t uiCount;
+  uint16_t uiUsed;
+  uint16_t uiLast = espuart_clock();
+  esptoken_t eToken = ESPTOK_NONE;
+
+  while ((uint16_t) (espuart_clock() - uiLast) <= uiREPL_SETTLE)
+  {
+    if (0 == (uiCount = espio_span(&pcData)))
+    {
+      continue;
+    }
+
+    uiUsed = esptok_scan(pcData, uiCount, &eToken);
+
+    /* Messages belong to the raw copy as well ("-o", "-R") */
+    rawCopy(uiTRANSCRIPT_RX, pcData, uiUsed);
+
+    espio_consume(uiUsed);
+
+    if ((ESPTOK_NONE != eToken) && !esptok_final(eToken))
+    {
+      output("\n", 1); /* End of a printable line */
+      filterLine();
+    }
+
+    uiLast = espuart_clock();
+  }
+
+  /* Message without line end (e.g. prompt): the input line starts below */
+  if (ESPTOK_NONE == eToken)
+  {
+    output("\n", 1);
+    esptok_reset(content);
+  }
+
+  render(true);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* historyAdd()                                                               */
+/*----------------------------------------------------------------------------*/
+void historyAdd(const char_t* acLine)
+{
+  uint16_t uiLen = strlen(acLine) + 1;
+  uint16_t uiDrop;
+  const char_t* pcNewest = historyGet(1);
+
+  /* Repeated commands are stored once */
+  if (pcNewest && (0 == strcmp(pcNewest, acLine)))
+  {
+    return;
+  }
+
+  while ((g_tState.repl.uiUsed + uiLen) > uiHISTORY_SIZE)
+  {
+    uiDrop = strlen(g_tState.repl.acHistory) + 1;
+    memmove(g_tState.repl.acHistory, &g_tState.repl.acHistory[uiDrop], g_tState.repl.uiUsed - uiDrop);
+    g_tState.repl.uiUsed -= uiDrop;
+    --g_tState.repl.uiCount;
+  }
+
+  memcpy(&g_tState.repl.acHistory[g_tState.repl.uiUsed], acLine, uiLen);
+  g_tState.repl.uiUsed += uiLen;
+  ++g_tState.repl.uiCount;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* historyGet()                                                               */
+/*----------------------------------------------------------------------------*/
+const char_t* historyGet(uint8_t uiIndex)
+{
+  uint16_t uiPos = g_tState.repl.uiUsed;
+
+  if ((0 == uiIndex) || (uiIndex > g_tState.repl.uiCount))
+  {
+    return 0;
+  }
+
+  /* Backwards from the newest command: each one starts behind a NUL */
+  while (uiIndex--)
+  {
+    for (--uiPos; (0 < uiPos) && ('\0' != g_tState.repl.acHistory[uiPos - 1]); --uiPos)
+    {
+    }
+  }
+
+  return &g_tState.repl.acHistory[uiPos];
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* editLine()                                                                 */
+/*----------------------------------------------------------------------------*/
+uint8_t editLine(const char_t* acText, uint8_t uiLen)
+{
+  while (uiLen--)
+  {
+    app_printf(stdout, "\b \b");
+  }
+
+  strncpy(g_tState.acCmd, acText, sizeof(g_tState.acCmd) - 1);
+  g_tState.acCmd[sizeof(g_tState.acCmd) - 1] = '\0';
+
+  app_printf(stdout, "%s", g_tState.acCmd);
+
+  return (uint8_t) strlen(g_tState.acCmd);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* readLine()                                                                 */
+/*----------------------------------------------------------------------------*/
+int readLine(char_t* acLine, uint8_t uiSize)
+{
+  uint8_t uiLen = 0;
+  uint16_t uiRead;
+  bool bData = false;
+  bool bLong = false;
+  char_t c;
+
+  for ( ; ; )
+  {
+    /* Refill read buffer blockwise */
+    if (g_tState.batch.uiPos >= g_tState.batch.uiFill)
+    {
+      g_tState.batch.uiPos = 0;
+      uiRead = esx_f_read(g_tState.batch.hFile, g_tState.batch.acBuffer, sizeof(g_tState.batch.acBuffer));
+
+      /* 0xFFFF: error of esxDOS; the buffer holds no data */
+      if (0xFFFF == uiRead)
+      {
+        g_tState.batch.uiFill = 0;
+        return iLINE_ERROR;
+      }
+
+      if (0 == (g_tState.batch.uiFill = (uint8_t) uiRead))
+      {
+        break; /* EOF */
+      }
+    }
+
+    c = g_tState.batch.acBuffer[g_tState.batch.uiPos++];
+    bData = true;
+
+    if ('\n' == c)
+    {
+      break;
+    }
+
+    if ('\r' != c)
+    {
+      if (uiLen < (uiSize - 1))
+      {
+        acLine[uiLen++] = c;
+      }
+      else
+      {
+        bLong = true; /* the rest of the line is skipped */
+      }
+    }
+  }
+
+  acLine[uiLen] = '\0';
+
+  if (bLong)
+  {
+    return iLINE_TOO_LONG;
+  }
+
+  return bData ? (int) uiLen : iLINE_EOF;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* upload()                                                                   */
+/*----------------------------------------------------------------------------*/
+int upload(void)
+{
+  struct esx_stat tStat;
+  uint32_t uiRemaining;
+  uint32_t uiSent    = 0;
+  uint32_t uiElapsed = 0;
+  uint16_t uiStart;
+  uint16_t uiChunk;
+  uint16_t uiLen;
+  int iResult = EOK;
+  int iReturn;
+
+  if (0xFF == (g_tState.xfer.hFile = esx_f_open(g_tState.pcXferFile, ESX_MODE_READ | ESX_MODE_OPEN_EXIST)))
+  {
+    app_printf(stderr, "cannot open %s\n", g_tState.pcXferFile);
+    return EBADF;
+  }
+
+  if (0 != esx_f_fstat(g_tState.xfer.hFile, &tStat))
+  {
+    iReturn = EBADF;
+    goto EXIT_UPLOAD;
+  }
+
+  uiRemaining = tStat.size;
+
+  if (EOK != (iReturn = openSession()))
+  {
+    goto EXIT_UPLOAD;
+  }
+
+  /* Single connection, normal transfer mode (errors: already configured) */
+  request("AT+CIPMUX=0", g_tState.uiTimeout);
+
+  espfmt_format(g_tState.acCmd, sizeof(g_tState.acCmd), "AT+CIPSTART=\"TCP\",\"%s\",%u",
+                g_tState.pcServer, g_tState.uiPort);
+
+  if (EOK != (iReturn = execute(g_tState.acCmd)))
+  {
+    goto EXIT_UPLOAD;
+  }
+
+  g_tState.xfer.uiFill = 0;
+  g_tState.xfer.uiPos  = 0;
+
+  if (uiRemaining)
+  {
+    iResult = readBlock();
+  }
+
+  esptok_prompt(true);
+  g_tState.rx.bSilent = true;
+
+  while (uiRemaining)
+  {
+    uiChunk = (uiRemaining > uiXFER_CHUNK) ? uiXFER_CHUNK : (uint16_t) uiRemaining;
+    uiStart = espuart_clock();
+
+    /* "OK" of the command, then the data prompt ("AT+CIPSTART" is done, its
+       buffer is free) */
+    espfmt_format(g_tState.acCmd, sizeof(g_tState.acCmd), "AT+CIPSEND=%u", uiChunk);
+
+    if ((EOK != (iReturn = transact(g_tState.acCmd, g_tState.uiTimeout))) ||
+        (EOK != (iReturn = awaitResponse(g_tState.uiTimeout))))
+    {
+      break;
+    }
+
+    uiRemaining -= uiChunk;
+    uiSent      += uiChunk;
+
+    while (uiChunk)
+    {
+      if (g_tState.xfer.uiPos == g_tState.xfer.uiFill)
+      {
+        iResult = readBlock();
+      }
+
+      uiLen = g_tState.xfer.uiFill - g_tState.xfer.uiPos;
+      uiLen = (uiLen > uiChunk) ? uiChunk : uiLen;
+
+      espuart_write(&g_tState.xfer.acBuffer[g_tState.xfer.uiPos], uiLen);
+      g_tState.xfer.uiPos += uiLen;
+      uiChunk             -= uiLen;
+    }
+
+    /* Read ahead while the ESP8266 forwards the chunk */
+    if (uiRemaining && (g_tState.xfer.uiPos == g_tState.xfer.uiFill))
+    {
+      iResult = readBlock();
+    }
+
+    if (EOK != (iReturn = awaitResponse(g_tState.uiTimeout)))
+    {
+      break;
+    }
+
+    uiElapsed += (uint16_t) (espuart_clock() - uiStart);
+
+    if (EOK != iResult)
+    {
+      iReturn = iResult;
+      break;
+    }
+  }
+
+  g_tState.rx.bSilent = false;
+  esptok_prompt(false);
+
+  if (EOK == iReturn)
+  {
+    app_printf(stdout, "%lu bytes, %lu bytes/s\n",
+               (unsigned long) uiSent, (unsigned long) transferRate(uiSent, uiElapsed));
+  }
+
+  /* Errors of the upload take precedence */
+  iResult = execute("AT+CIPCLOSE");
+  iReturn = (EOK != iReturn) ? iReturn : iResult;
+
+EXIT_UPLOAD:
+  esx_f_close(g_tState.xfer.hFile);
+  g_tState.xfer.hFile = 0xFF;
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* download()                                                                 */
+/*----------------------------------------------------------------------------*/
+int download(void)
+{
+  const char_t* pcData;
+  uint32_t uiReceived = 0;
+  uint32_t uiElapsed  = 0;
+  uint16_t uiSpan;
+  uint16_t uiCount;
+  uint16_t uiUsed;
+  uint16_t uiLast;
+  uint16_t uiNow;
+  espuart_stats_t tStats;
+  bool bStarted = false;
+  bool bIdle    = false;
+  int iResult   = EOK;
+  int iReturn;
+
+  if (0xFF == (g_tState.xfer.hFile = esx_f_open(g_tState.pcXferFile, ESX_MODE_WRITE | ESX_MODE_OPEN_CREAT_TRUNC)))
+  {
+    app_printf(stderr, "cannot create %s\n", g_tState.pcXferFile);
+    return EBADF;
+  }
+
+  if (EOK != (iReturn = openSession()))
+  {
+    goto EXIT_DOWNLOAD;
+  }
+
+  /* Single connection (errors: already configured) */
+  request("AT+CIPMUX=0", g_tState.uiTimeout);
+
+  espfmt_format(g_tState.acCmd, sizeof(g_tState.acCmd), "AT+CIPSTART=\"TCP\",\"%s\",%u",
+                g_tState.pcServer, g_tState.uiPort);
+
+  if (EOK != (iReturn = execute(g_tState.acCmd)))
+  {
+    goto EXIT_DOWNLOAD;
+  }
+
+  /* Transparent mode: "OK" of AT+CIPSEND, then the prompt */
+  esptok_prompt(true);
+  g_tState.rx.bSilent = true;
+
+  if ((EOK == (iReturn = transact("AT+CIPMODE=1", g_tState.uiTimeout))) &&
+      (EOK == (iReturn = transact("AT+CIPSEND", g_tState.uiTimeout))))
+  {
+    iReturn = awaitResponse(g_tState.uiTimeout);
+  }
+
+  g_tState.rx.bSilent = false;
+  esptok_prompt(false);
+
+  if (EOK != iReturn)
+  {
+    goto EXIT_CLOSE;
+  }
+
+  /* From now on everything is data; a space after the prompt is not */
+  if ((0 != espio_span(&pcData)) && (' ' == *pcData))
+  {
+    espio_consume(1);
+  }
+
+  memset(&g_tState.http, 0, sizeof(g_tState.http));
+
+  if (g_tState.pcPath)
+  {
+    g_tState.http.bHeader = true;
+
+    sendText("GET ");
+    sendText(g_tState.pcPath);
+    sendText(" HTTP/1.0\r\nHost: ");
+    sendText(g_tState.pcServer);
+    sendText("\r\n\r\n");
+  }
+
+  g_tState.xfer.uiFill   = 0;
+  g_tState.xfer.uiBlock  = 0;
+  g_tState.xfer.bPending = false;
+
+  espuart_stats(&tStats);
+  uiLast = espuart_clock();
+
+  for ( ; ; )
+  {
+    uiNow = espuart_clock();
+
+    if (0 == (uiSpan = espio_span(&pcData)))
+    {
+      /* Gap in the data stream: write the full block */
+      if (g_tState.xfer.bPending)
+      {
+        g_tState.xfer.bPending = false;
+
+        if (EOK != (iResult = writeBlock(g_tState.xfer.uiBlock ^ 1, uiXFER_BLOCK)))
+        {
+          break;
+        }
+
+        uiLast = espuart_clock();
+        continue;
+      }
+
+      /* No end of the stream in transparent mode: idle timeout */
+      if ((uint16_t) (uiNow - uiLast) > g_tState.uiTimeout)
+      {
+        bIdle = true;
+        break;
+      }
+
+      continue;
+    }
+
+    if (bStarted)
+    {
+      uiElapsed += (uint16_t) (uiNow - uiLast);
+    }
+
+    bStarted = true;
+    uiLast   = uiNow;
+
+    for (uiUsed = 0; g_tState.http.bHeader && (uiUsed < uiSpan); )
+    {
+      if (httpHeader(pcData[uiUsed++]))
+      {
+        g_tState.http.bHeader = false;
+      }
+    }
+
+    uiCount = uiSpan - uiUsed;
+
+    if (g_tState.http.bLength && (uiCount > (g_tState.http.uiLength - uiReceived)))
+    {
+      uiCount = (uint16_t) (g_tState.http.uiLength - uiReceived);
+    }
+
+    if (uiCount)
+    {
+      if (EOK != (iResult = storeData(&pcData[uiUsed], uiCount)))
+      {
+        break;
+      }
+
+      uiReceived += uiCount;
+    }
+
+    espio_consume(uiSpan);
+
+    if (g_tState.http.bLength && !g_tState.http.bHeader && (uiReceived == g_tState.http.uiLength))
+    {
+      break;
+    }
+  }
+
+  /* Rest of the data */
+  if (EOK == iResult)
+  {
+    iResult = flushBlocks();
+  }
+
+  leaveTransparent();
+
+  if (EOK != iResult)
+  {
+    iReturn = iResult;
+  }
+  else if (g_tState.pcPath)
+  {
+    if (g_tState.http.bHeader || (g_tState.http.bLength && (uiReceived != g_tState.http.uiLength)))
+    {
+      iReturn = ETIMEOUT;
+    }
+    else if (200 != g_tState.http.uiStatus)
+    {
+      app_printf(stderr, "HTTP status %u\n", g_tState.http.uiStatus);
+      iReturn = ESTAT;
+    }
+  }
+  else if (0 == uiReceived)
+  {
+    iReturn = ETIMEOUT;
+  }
+
+  app_printf(stdout, "%lu bytes, %lu bytes/s\n",
+             (unsigned long) uiReceived, (unsigned long) transferRate(uiReceived, uiElapsed));
+
+  /* Without "Content-Length" the end of the file and a stalled stream look
+     the same: only the idle timeout ends the transfer */
+  if ((EOK == iReturn) && bIdle)
+  {
+    app_printf(stderr, "end by timeout: possibly incomplete\n");
+  }
+
+  /* Throttling by the flow control ("-F") and lost data of the stream */
+  espuart_stats(&tStats);
+
+  if (g_tState.bFlowActive || tStats.uiOverruns)
+  {
+    app_printf(stdout, "fifo: %u throttled, %u overruns\n", tStats.uiThrottled, tStats.uiOverruns);
+  }
+
+EXIT_CLOSE:
+  /* Errors of the download take precedence */
+  request("AT+CIPMODE=0", g_tState.uiTimeout);
+  iResult = execute("AT+CIPCLOSE");
+  iReturn = (EOK != iReturn) ? iReturn : iResult;
+
+EXIT_DOWNLOAD:
+  esx_f_close(g_tState.xfer.hFile);
+  g_tState.xfer.hFile = 0xFF;
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* httpHeader()                                                               */
+/*----------------------------------------------------------------------------*/
+bool httpHeader(char_t c)
+{
+  static const char_t acLength[] = "content-length:";
+
+  if ('\n' == c)
+  {
+    /* Empty line: end of the header */
+    if (0 == g_tState.http.uiLine)
+    {
+      return true;
+    }
+
+    g_tState.http.uiLine  = 0;
+    g_tState.http.uiMatch = 0;
+    g_tState.http.bStatus = true;
+  }
+  else if ('\r' != c)
+  {
+    if (!g_tState.http.bStatus)
+    {
+      /* "HTTP/1.x 200 OK": the code follows the first space */
+      if (' ' == c)
+      {
+        g_tState.http.uiMatch += g_tState.http.uiLine ? 1 : 0;
+      }
+      else if ((1 == g_tState.http.uiMatch) && isdigit(c))
+      {
+        g_tState.http.uiStatus = (g_tState.http.uiStatus * 10) + (c - '0');
+      }
+    }
+    else if ((sizeof(acLength) - 1) == g_tState.http.uiMatch)
+    {
+      if (isdigit(c))
+      {
+        g_tState.http.uiLength = (g_tState.http.uiLength * 10) + (c - '0');
+        g_tState.http.bLength  = true;
+      }
+    }
+    else if ((g_tState.http.uiMatch == g_tState.http.uiLine) &&
+             (acLength[g_tState.http.uiMatch] == (char_t) tolower(c)))
+    {
+      ++g_tState.http.uiMatch;
+    }
+
+    /* Leading spaces are ignored */
+    if ((' ' != c) || g_tState.http.uiLine)
+    {
+      ++g_tState.http.uiLine;
+    }
+  }
+
+  return false;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* storeData()                                                                */
+/*----------------------------------------------------------------------------*/
+int storeData(const char_t* pcData, uint16_t uiLen)
+{
+  uint16_t uiCount;
+
+  while (uiLen)
+  {
+    uiCount = uiXFER_BLOCK - g_tState.xfer.uiFill;
+    uiCount = (uiCount > uiLen) ? uiLen : uiCount;
+
+    memcpy(&g_tState.xfer.acBuffer[(g_tState.xfer.uiBlock * uiXFER_BLOCK) + g_tState.xfer.uiFill],
+           pcData, uiCount);
+
+    g_tState.xfer.uiFill += uiCount;
+    pcData += uiCount;
+    uiLen  -= uiCount;
+
+    if (uiXFER_BLOCK == g_tState.xfer.uiFill)
+    {
+      /* Both blocks full: the older one has to be written now */
+      if (g_tState.xfer.bPending &&
+          (EOK != writeBlock(g_tState.xfer.uiBlock ^ 1, uiXFER_BLOCK)))
+      {
+        return EBADF;
+      }
+
+      g_tState.xfer.bPending = true;
+      g_tState.xfer.uiBlock ^= 1;
+      g_tState.xfer.uiFill   = 0;
+    }
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* writeBlock()                                                               */
+/*----------------------------------------------------------------------------*/
+int writeBlock(uint8_t uiBlock, uint16_t uiLen)
+{
+  if (uiLen != esx_f_write(g_tState.xfer.hFile, &g_tState.xfer.acBuffer[uiBlock * uiXFER_BLOCK], uiLen))
+  {
+    return EBADF;
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* flushBlocks()                                                              */
+/*----------------------------------------------------------------------------*/
+int flushBlocks(void)
+{
+  int iReturn = EOK;
+
+  if (g_tState.xfer.bPending)
+  {
+    g_tState.xfer.bPending = false;
+    iReturn = writeBlock(g_tState.xfer.uiBlock ^ 1, uiXFER_BLOCK);
+  }
+
+  if ((EOK == iReturn) && g_tState.xfer.uiFill)
+  {
+    iReturn = writeBlock(g_tState.xfer.uiBlock, g_tState.xfer.uiFill);
+    g_tState.xfer.uiFill = 0;
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* openCapture()                                                              */
+/*----------------------------------------------------------------------------*/
+int openCapture(void)
+{
+  uint8_t uiMode;
+
+  if (!g_tState.pcRawFile || (0xFF != g_tState.xfer.hFile))
+  {
+    return EOK;
+  }
+
+  /* A transcript starts with its identification: never appended */
+  uiMode = ESX_MODE_WRITE | ((g_tState.bAppend && !g_tState.transcript.bRecord) ? ESX_MODE_OPEN_CREAT : ESX_MODE_OPEN_CREAT_TRUNC);
+
+  if (0xFF == (g_tState.xfer.hFile = esx_f_open(g_tState.pcRawFile, uiMode)))
+  {
+    app_printf(stderr, "cannot create %s\n", g_tState.pcRawFile);
+    return EBADF;
+  }
+
+  if (g_tState.bAppend && !g_tState.transcript.bRecord)
+  {
+    esx_f_seek(g_tState.xfer.hFile, 0, ESX_SEEK_END);
+  }
+
+  g_tState.xfer.uiFill   = 0;
+  g_tState.xfer.uiBlock  = 0;
+  g_tState.xfer.bPending = false;
+  g_tState.transcript.uiClock = espuart_clock();
+
+  return g_tState.transcript.bRecord ? storeData(acTRANSCRIPT_MAGIC, sizeof(acTRANSCRIPT_MAGIC) - 1) : EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* closeCapture()                                                             */
+/*----------------------------------------------------------------------------*/
+int closeCapture(void)
+{
+  int iReturn = EOK;
+
+  if (g_tState.pcRawFile && (0xFF != g_tState.xfer.hFile))
+  {
+    if (EOK != (iReturn = flushBlocks()))
+    {
+      app_printf(stderr, "cannot write %s\n", g_tState.pcRawFile);
+    }
+
+    esx_f_close(g_tState.xfer.hFile);
+    g_tState.xfer.hFile = 0xFF;
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* rawCopy()                                                                  */
+/*----------------------------------------------------------------------------*/
+int rawCopy(uint8_t uiType, const char_t* pcData, uint16_t uiLen)
+{
+  uint8_t* pHeader = g_tState.transcript.acHeader;
+  uint16_t uiNow;
+  uint16_t uiDelta;
+
+  if (!g_tState.pcRawFile || g_tState.rx.bSilent || (0 == uiLen))
+  {
+    return EOK;
+  }
+
+  /* The raw copy contains the echo of the commands */
+  if (!g_tState.transcript.bRecord)
+  {
+    return (uiTRANSCRIPT_RX == uiType) ? storeData(pcData, uiLen) : EOK;
+  }
+
+  uiNow   = espuart_clock();
+  uiDelta = uiNow - g_tState.transcript.uiClock;
+  g_tState.transcript.uiClock = uiNow;
+
+  pHeader[0] = uiType;
+  pHeader[1] = (uint8_t) uiDelta;
+  pHeader[2] = (uint8_t) (uiDelta >> 8);
+  pHeader[3] = (uint8_t) uiLen;
+  pHeader[4] = (uint8_t) (uiLen >> 8);
+
+  if (EOK != storeData((const char_t*) pHeader, uiTRANSCRIPT_HEADER))
+  {
+    return EBADF;
+  }
+
+  return storeData(pcData, uiLen);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* replay()                                                                   */
+/*----------------------------------------------------------------------------*/
+int replay(void)
+{
+  char_t acMagic[sizeof(acTRANSCRIPT_MAGIC) - 1];
+  const uint8_t* pHeader = g_tState.transcript.acHeader;
+  uint16_t uiDelta;
+  uint16_t uiLen;
+  uint8_t uiType;
+  uint8_t uiEntry;
+  int iReturn = EOK;
+  int iResult;
+
+  if (0xFF == (g_tState.xfer.hFile = esx_f_open(g_tState.transcript.pcFile, ESX_MODE_READ | ESX_MODE_OPEN_EXIST)))
+  {
+    app_printf(stderr, "cannot open %s\n", g_tState.transcript.pcFile);
+    return EBADF;
+  }
+
+  g_tState.xfer.uiFill = 0;
+  g_tState.xfer.uiPos  = 0;
+  g_tState.transcript.bHeader = false;
+  g_tState.transcript.bEnd    = false;
+  g_tState.transcript.uiLeft  = 0;
+
+  if ((sizeof(acMagic) != replayRead((uint8_t*) acMagic, sizeof(acMagic))) ||
+      (0 != memcmp(acMagic, acTRANSCRIPT_MAGIC, sizeof(acMagic))))
+  {
+    app_printf(stderr, "no transcript: %s\n", g_tState.transcript.pcFile);
+    iReturn = EINVAL;
+    goto EXIT_REPLAY;
+  }
+
+  /* The recorded responses replace the UART */
+  espio_reset();
+  espio_source(replaySource);
+  g_tState.transcript.uiClock = espuart_clock();
+
+  while (0 != (uiType = replayNext()))
+  {
+    uiDelta = pHeader[1] | ((uint16_t) pHeader[2] << 8);
+    uiLen   = pHeader[3] | ((uint16_t) pHeader[4] << 8);
+    g_tState.transcript.bHeader = false;
+
+    /* Received data that no response took (e.g. after a timeout) */
+    if ((uiTRANSCRIPT_CMD != uiType) || (sizeof(g_tState.acCmd) <= uiLen))
+    {
+      while (uiLen && replayRead((uint8_t*) g_tState.acCmd, (uiLen < sizeof(g_tState.acCmd)) ? uiLen : sizeof(g_tState.acCmd)))
+      {
+        uiLen -= (uiLen < sizeof(g_tState.acCmd)) ? uiLen : sizeof(g_tState.acCmd);
+      }
+      continue;
+    }
+
+    if (uiLen != replayRead((uint8_t*) g_tState.acCmd, uiLen))
+    {
+      break;
+    }
+
+    g_tState.acCmd[uiLen] = '\0';
+
+    /* Rest of a response that ended early on a pattern: not recorded */
+    g_tState.transcript.bEnd = true;
+    awaitOutstanding(0);
+
+    while (!g_tState.transcript.bFast && ((uint16_t) (espuart_clock() - g_tState.transcript.uiClock) < uiDelta))
+    {
+    }
+
+    g_tState.transcript.uiClock = espuart_clock();
+    g_tState.transcript.bEnd    = false;
+
+    app_printf(stdout, "> %s\n", g_tState.acCmd);
+
+    iResult = transact(g_tState.acCmd, commandTimeout(g_tState.acCmd, &uiEntry));
+
+    if (espkv_active())
+    {
+      espkv_line();
+      exportWrite();
+    }
+
+    if (g_tState.timing.bEnabled)
+    {
+      recordTiming(g_tState.acCmd, iResult);
+    }
+
+    if (EOK != iResult)
+    {
+      app_printf(stderr, "error %d\n", iResult);
+
+      /* The first error determines the exitcode of the replay */
+      if (EOK == iReturn)
+      {
+        iReturn = iResult;
+      }
+    }
+  }
+
+  espio_source(0);
+
+EXIT_REPLAY:
+  esx_f_close(g_tState.xfer.hFile);
+  g_tState.xfer.hFile = 0xFF;
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* replaySource()                                                             */
+/*----------------------------------------------------------------------------*/
+uint16_t replaySource(uint8_t* pDst, uint16_t uiSize)
+{
+  const uint8_t* pHeader = g_tState.transcript.acHeader;
+
+  if (g_tState.transcript.bEnd)
+  {
+    return 0;
+  }
+
+  /* Next record of received data; a command ends the response */
+  if (0 == g_tState.transcript.uiLeft)
+  {
+    if (uiTRANSCRIPT_RX != replayNext())
+    {
+      g_tState.transcript.bEnd = true;
+      return 0;
+    }
+
+    /* Recorded pace: the data arrives after the recorded delay */
+    if (!g_tState.transcript.bFast &&
+        ((uint16_t) (espuart_clock() - g_tState.transcript.uiClock) < (pHeader[1] | ((uint16_t) pHeader[2] << 8))))
+    {
+      return 0;
+    }
+
+    g_tState.transcript.uiClock = espuart_clock();
+    g_tState.transcript.uiLeft  = pHeader[3] | ((uint16_t) pHeader[4] << 8);
+    g_tState.transcript.bHeader = false;
+  }
+
+  if (uiSize > g_tState.transcript.uiLeft)
+  {
+    uiSize = g_tState.transcript.uiLeft;
+  }
+
+  /* A truncated file ends the record */
+  uiSize = replayRead(pDst, uiSize);
+  g_tState.transcript.uiLeft = uiSize ? (g_tState.transcript.uiLeft - uiSize) : 0;
+
+  return uiSize;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* replayNext()                                                               */
+/*----------------------------------------------------------------------------*/
+uint8_t replayNext(void)
+{
+  if (!g_tState.transcript.bHeader)
+  {
+    if (uiTRANSCRIPT_HEADER != replayRead(g_tState.transcript.acHeader, uiTRANSCRIPT_HEADER))
+    {
+      return 0;
+    }
+
+    g_tState.transcript.bHeader = true;
+  }
+
+  return g_tState.transcript.acHeader[0];
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* replayRead()                                                               */
+/*----------------------------------------------------------------------------*/
+uint16_t replayRead(uint8_t* pDst, uint16_t uiLen)
+{
+  uint16_t uiDone = 0;
+  uint16_t uiCount;
+
+  while (uiDone < uiLen)
+  {
+    if (g_tState.xfer.uiPos == g_tState.xfer.uiFill)
+    {
+      g_tState.xfer.uiPos  = 0;
+      g_tState.xfer.uiFill = esx_f_read(g_tState.xfer.hFile, g_tState.xfer.acBuffer, sizeof(g_tState.xfer.acBuffer));
+
+      if ((0 == g_tState.xfer.uiFill) || (sizeof(g_tState.xfer.acBuffer) < g_tState.xfer.uiFill))
+      {
+        g_tState.xfer.uiFill = 0;
+        break; /* EOF */
+      }
+    }
+
+    uiCount = g_tState.xfer.uiFill - g_tState.xfer.uiPos;
+    uiCount = (uiCount > (uiLen - uiDone)) ? (uiLen - uiDone) : uiCount;
+
+    memcpy(&pDst[uiDone], &g_tState.xfer.acBuffer[g_tState.xfer.uiPos], uiCount);
+    g_tState.xfer.uiPos += uiCount;
+    uiDone += uiCount;
+  }
+
+  return uiDone;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* exportSink()                                                               */
+/*----------------------------------------------------------------------------*/
+void exportSink(const char_t* pcData, uint16_t uiLen, void* pContext)
+{
+  uint16_t uiCount;
+
+  (void) pContext;
+
+  while (uiLen)
+  {
+    if (uiEXPORT_BLOCK == g_tState.export.uiFill)
+    {
+      exportWrite();
+    }
+
+    uiCount = uiEXPORT_BLOCK - g_tState.export.uiFill;
+    uiCount = (uiCount > uiLen) ? uiLen : uiCount;
+
+    memcpy(&g_tState.export.acBuffer[g_tState.export.uiFill], pcData, uiCount);
+    g_tState.export.uiFill += (uint8_t) uiCount;
+    pcData += uiCount;
+    uiLen  -= uiCount;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* exportWrite()                                                              */
+/*----------------------------------------------------------------------------*/
+int exportWrite(void)
+{
+  uint16_t uiFill = g_tState.export.uiFill;
+  uint8_t* pMemory;
+  uint8_t uiPage;
+  uint8_t hFile;
+  int iReturn = EOK;
+
+  g_tState.export.uiFill = 0;
+
+  if (g_tState.export.uiAddress)
+  {
+    /* Records of all commands one after the other; a NUL ends the list */
+    if (uiFill >= (g_tState.export.uiEnd - g_tState.export.uiAddress))
+    {
+      uiFill = g_tState.export.uiEnd - g_tState.export.uiAddress - 1;
+    }
+
+    /* A page of "-M" mapped over the memory of BASIC (replay of a response) */
+    if (0xFF != (uiPage = espuart_mapped()))
+    {
+      espuart_unmap();
+    }
+
+    pMemory = espuart_memory(g_tState.export.uiAddress);
+    memcpy(pMemory, g_tState.export.acBuffer, uiFill);
+    pMemory[uiFill] = '\0';
+    g_tState.export.uiAddress += uiFill;
+
+    if (0xFF != uiPage)
+    {
+      espuart_map(uiPage);
+    }
+  }
+  else if (0xFF != (hFile = esx_f_open(g_tState.export.pcFile,
+                                       ESX_MODE_WRITE | (g_tState.export.bStarted ? ESX_MODE_OPEN_CREAT : ESX_MODE_OPEN_CREAT_TRUNC))))
+  {
+    /* The first command replaces the records of a previous invocation */
+    if (g_tState.export.bStarted)
+    {
+      esx_f_seek(hFile, 0, ESX_SEEK_END);
+    }
+
+    if (uiFill != esx_f_write(hFile, g_tState.export.acBuffer, uiFill))
+    {
+      iReturn = EBADF;
+    }
+
+    esx_f_close(hFile);
+    g_tState.export.bStarted = true;
+  }
+  else
+  {
+    iReturn = EBADF;
+  }
+
+  if (EOK != iReturn)
+  {
+    app_printf(stderr, "cannot write %s\n", g_tState.export.pcFile);
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* leaveTransparent()                                                         */
+/*----------------------------------------------------------------------------*/
+void leaveTransparent(void)
+{
+  /* "+++" is only detected as a packet of its own */
+  discard(uiXFER_GUARD);
+  sendText("+++");
+  discard(uiXFER_ESCAPE);
+
+  espio_reset();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* discard()                                                                  */
+/*----------------------------------------------------------------------------*/
+void discard(uint16_t uiTime)
+{
+  const char_t* pcData;
+  uint16_t uiStart = espuart_clock();
+  uint16_t uiCount;
+
+  while ((uint16_t) (espuart_clock() - uiStart) <= uiTime)
+  {
+    if (0 != (uiCount = espio_span(&pcData)))
+    {
+      espio_consume(uiCount);
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* sendText()                                                                 */
+/*----------------------------------------------------------------------------*/
+void sendText(const char_t* acText)
+{
+  espuart_write((const uint8_t*) acText, strlen(acText));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* readBlock()                                                                */
+/*----------------------------------------------------------------------------*/
+int readBlock(void)
+{
+  g_tState.xfer.uiPos  = 0;
+  g_tState.xfer.uiFill = esx_f_read(g_tState.xfer.hFile, g_tState.xfer.acBuffer, uiXFER_BLOCK);
+
+  /* End of file or error of esxDOS (0xFFFF): the chunk is padded */
+  if ((0 == g_tState.xfer.uiFill) || (uiXFER_BLOCK < g_tState.xfer.uiFill))
+  {
+    memset(g_tState.xfer.acBuffer, 0, uiXFER_BLOCK);
+    g_tState.xfer.uiFill = uiXFER_BLOCK;
+    return EBADF;
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* transferRate()                                                             */
+/*----------------------------------------------------------------------------*/
+uint32_t transferRate(uint32_t uiBytes, uint32_t uiTime)
+{
+  if (0 == uiTime)
+  {
+    uiTime = 1;
+  }
+
+  /* No overflow of the 32 bit arithmetic for large transfers */
+  if (uiBytes < (0xFFFFFFFFUL / 1000))
+  {
+    return (uiBytes * 1000) / uiTime;
+  }
+
+  return uiBytes / ((uiTime < 1000) ? 1 : (uiTime / 1000));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* openSession()                                                              */
+/*----------------------------------------------------------------------------*/
+int openSession(void)
+{
+  uint32_t uiStart = espuart_micros();
+  const char_t* pcData;
+  uint16_t uiCount;
+  int iReturn;
+
+  if (!isLinkValid() ||
+      ((uiESP_DEFAULT_BAUDRATE < g_tState.uiBaudrate) && (EOK != syncLink(uiCACHE_PROBES))))
+  {
+    iReturn = initSession();
+  }
+  else
+  {
+    /* Link verified by a previous invocation: no reconfiguration, no sync */
+    g_tState.link.bCached = true;
+    espio_reset();
+
+    /* Discard late responses of the previous invocation (e.g. "-w") */
+    while (0 != (uiCount = espio_span(&pcData)))
+    {
+      espio_consume(uiCount);
+    }
+
+    if (EOK != esp_set_timeout(&g_tState.tEsp, g_tState.uiTimeout))
+    {
+      iReturn = ENOTSUP;
+    }
+    else if (g_tState.bFlow && (EOK != enableFlow()))
+    {
+      iReturn = ETIMEOUT;
+    }
+    else
+    {
+      iReturn = g_tState.bTurbo ? enableTurbo() : EOK;
+    }
+  }
+
+  /* Without reserved memory or above the rate of the frame interrupt (no
+     flow control) the session continues with polling */
+  if ((EOK == iReturn) && g_tState.bIrq)
+  {
+    if (!g_tState.bFlowActive &&
+        ((g_tState.uiTurboBaudrate ? g_tState.uiTurboBaudrate : g_tState.uiBaudrate) > uiESPUART_IRQ_MAX_BAUDRATE))
+    {
+      app_printf(stderr, "irq: max. %lu bit/s without -F\n", (unsigned long) uiESPUART_IRQ_MAX_BAUDRATE);
+    }
+    else if (EOK != espio_irq(true))
+    {
+      app_printf(stderr, "irq: CLEAR %u first\n", uiESPUART_IM2_TABLE - 1);
+    }
+  }
+
+  /* Without free memory the responses are processed while received */
+  if ((EOK == iReturn) && g_tState.uiPages && !espbank_pages())
+  {
+    if (EOK != espbank_open(g_tState.uiPages))
+    {
+      app_printf(stderr, "mem: %u pages not available\n", g_tState.uiPages);
+    }
+  }
+
+  g_tState.timing.uiSetup = espuart_micros() - uiStart;
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* initSession()                                                              */
+/*----------------------------------------------------------------------------*/
+int initSession(void)
+{
+  g_tState.link.bCached = false;
+
+  disableFlow();
+  disableTurbo();
+
+  /* Initialize UART / ESP8266 */
+  if (EOK != esp_set_timeout(&g_tState.tEsp, g_tState.uiTimeout))
+  {
+    return ENOTSUP;
+  }
+
+  if (g_tState.bAutoBaud)
+  {
+    if (EOK != detectBaudrate())
+    {
+      return ETIMEOUT;
+    }
+  }
+  else
+  {
+    if (EOK != esp_set_baudrate(&g_tState.tEsp, g_tState.uiBaudrate))
+    {
+      return ENOTSUP;
+    }
+
+    if (EOK != syncLink(uiSYNC_PROBES))
+    {
+      return ETIMEOUT;
+    }
+  }
+
+  /* New link state; written back after the first successful sync. The
+     learned response times survive, they do not depend on the link. */
+  memset(&g_tState.link.tState, 0, offsetof(linkstate_t, auiLearned));
+  g_tState.link.tState.uiBaudrate = g_tState.uiBaudrate;
+  g_tState.link.bDirty = true;
+
+  queryFirmware();
+
+  /* Flow control first: the probes of "turbo" are protected already */
+  if (g_tState.bFlow && (EOK != enableFlow()))
+  {
+    return ETIMEOUT;
+  }
+
+  if (g_tState.bTurbo)
+  {
+    return enableTurbo();
+  }
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* syncLink()                                                                 */
+/*----------------------------------------------------------------------------*/
+int syncLink(uint8_t uiProbes)
+{
+  const char_t* pcData;
+  uint16_t uiStart  = espuart_clock();
+  uint16_t uiBudget = (uint16_t) uiProbes * uiSYNC_PROBE;
+  uint16_t uiProbe  = 0;
+  uint16_t uiCount;
+  esptoken_t eToken;
+  uint8_t uiSent     = 0;
+  uint8_t uiAnswered = 0;
+  bool bProbe   = true;
+  bool bEcho    = false;
+  bool bDrained = false;
+  bool bSynced  = false;
+
+  espio_reset();
+
+  for ( ; ; )
+  {
+    /* Hard limit from the start: a stream of data cannot extend the sync */
+    if ((uint16_t) (espuart_clock() - uiStart) >= uiBudget)
+    {
+      break;
+    }
+
+    if (bProbe && !bSynced)
+    {
+      ESPTRACE(ESPTRACE_PROBE, (uint16_t) (espuart_clock() - uiStart));
+
+      /* Without echo only the "OK" to a probe into an empty buffer counts */
+      bDrained = (0 == espio_span(&pcData));
+
+      if ((EOK != esp_transmit(&g_tState.tEsp, acSYNC_PROBE)) ||
+          (EOK != esp_transmit(&g_tState.tEsp, "\r\n")))
+      {
+        return ENOTSUP;
+      }
+
+      esptok_reset(syncSink);
+      g_tState.rx.uiEcho = uiSYNC_NO_ECHO;
+      bProbe  = false;
+      bEcho   = false;
+      uiProbe = espuart_clock();
+      ++uiSent;
+    }
+
+    /* Fixed period of the probes, with or without received data; after the
+       echo the ESP8266 is busy with the probe and only its answer is due */
+    bProbe = !bEcho && ((uint16_t) (espuart_clock() - uiProbe) >= uiSYNC_PROBE);
+
+    if (0 == (uiCount = espio_span(&pcData)))
+    {
+      continue;
+    }
+
+    espio_consume(esptok_scan(pcData, uiCount, &eToken));
+
+    if (ESPTOK_DATA == eToken)
+    {
+      /* Older output precedes the echo: the next "OK" is the own one */
+      bEcho = bEcho || (uiSYNC_ECHO == g_tState.rx.uiEcho);
+      g_tState.rx.uiEcho = uiSYNC_NO_ECHO;
+      continue;
+    }
+
+    if (esptok_final(eToken) || (ESPTOK_BUSY == eToken))
+    {
+      ++uiAnswered;
+      bSynced = bSynced || ((ESPTOK_OK == eToken) && (bEcho || bDrained));
+    }
+
+    /* Busy with a previous command: wait up to the timeout of a command, the
+       rejected probe is repeated with the next period */
+    if ((ESPTOK_BUSY == eToken) && !bSynced)
+    {
+      uiBudget = (g_tState.uiTimeout > uiBudget) ? g_tState.uiTimeout : uiBudget;
+      bEcho    = false;
+    }
+
+    /* The answers of the other probes must not end the next command */
+    if (bSynced && (uiAnswered >= uiSent))
+    {
+      break;
+    }
+  }
+
+  if (bSynced)
+  {
+    syncLinkState();
+    return EOK;
+  }
+
+  return ETIMEOUT;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* detectBaudrate()                                                           */
+/*----------------------------------------------------------------------------*/
+int detectBaudrate(void)
+{
+  uint32_t uiFirst = g_tState.uiBaudrate;
+  uint32_t uiRate  = uiFirst;
+  uint16_t uiStart = espuart_clock();
+  uint8_t i = 0;
+
+  for ( ; ; )
+  {
+    if ((uint16_t) (espuart_clock() - uiStart) >= uiAUTOBAUD_LIMIT)
+    {
+      return ETIMEOUT;
+    }
+
+    ESPTRACE(ESPTRACE_BAUD, uiRate / 100);
+
+    if ((EOK == esp_set_baudrate(&g_tState.tEsp, uiRate)) &&
+        (EOK == syncLink(uiAUTOBAUD_PROBES)))
+    {
+      break;
+    }
+
+    /* Next candidate; the rate of the last session is not probed twice */
+    do
+    {
+      if ((sizeof(g_auiAutoBaudrates) / sizeof(g_auiAutoBaudrates[0])) <= i)
+      {
+        return ETIMEOUT;
+      }
+
+      uiRate = g_auiAutoBaudrates[i++];
+    }
+    while (uiRate == uiFirst);
+  }
+
+  if (uiRate != uiFirst)
+  {
+    app_printf(stdout, "baudrate: %lu bit/s\n", (unsigned long) uiRate);
+  }
+
+  g_tState.uiBaudrate = uiRate;
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* syncSink()                                                                 */
+/*----------------------------------------------------------------------------*/
+void syncSink(const char_t* pcData, uint16_t uiLen, bool bFirst)
+{
+  uint8_t uiEcho = bFirst ? 0 : g_tState.rx.uiEcho;
+
+  while (uiLen--)
+  {
+    uiEcho = ((uiSYNC_ECHO > uiEcho) && (acSYNC_PROBE[uiEcho] == *pcData++)) ?
+             uiEcho + 1 : uiSYNC_NO_ECHO;
+  }
+
+  g_tState.rx.uiEcho = uiEcho;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* loadTimeouts()                                                             */
+/*----------------------------------------------------------------------------*/
+int loadTimeouts(void)
+{
+  linkstate_t* pState = &g_tState.link.tState;
+  usertimeout_t* pEntry;
+  struct esx_stat tStat;
+  char_t* pcLine;
+  char_t* pcValue;
+  uint8_t uiLine = 0;
+  int iLen;
+
+  /* The script file is not opened yet: its buffer is reused */
+  g_tState.batch.uiFill = 0;
+  g_tState.batch.uiPos  = 0;
+
+  if (0xFF == (g_tState.batch.hFile = esx_f_open(acTIMEOUT_FILE, ESX_MODE_READ | ESX_MODE_OPEN_EXIST)))
+  {
+    /* Entries of a removed file must not survive in the link state */
+    if (pState->uiUser || pState->uiUserSize)
+    {
+      pState->uiUser     = 0;
+      pState->uiUserTime = 0;
+      pState->uiUserDate = 0;
+      pState->uiUserSize = 0;
+      g_tState.link.bDirty = true;
+    }
+
+    return EBADF;
+  }
+
+  if (0 != esx_f_fstat(g_tState.batch.hFile, &tStat))
+  {
+    tStat.size = 0;
+  }
+
+  /* Unchanged file: the entries of the link state are used */
+  if (tStat.size &&
+      (tStat.size      == pState->uiUserSize) &&
+      (tStat.time.time == pState->uiUserTime) &&
+      (tStat.time.date == pState->uiUserDate))
+  {
+    goto EXIT_TIMEOUTS;
+  }
+
+  pState->uiUser     = 0;
+  pState->uiUserTime = tStat.time.time;
+  pState->uiUserDate = tStat.time.date;
+  pState->uiUserSize = tStat.size;
+  g_tState.link.bDirty = true;
+
+  /* The command buffer is not used before the session is opened */
+  while ((iLINE_EOF != (iLen = readLine(g_tState.acCmd, sizeof(g_tState.acCmd)))) &&
+         (uiMAX_USER_TIMEOUTS > pState->uiUser))
+  {
+    ++uiLine;
+
+    if (iLINE_ERROR == iLen)
+    {
+      app_printf(stderr, "cannot read %s\n", acTIMEOUT_FILE);
+      break;
+    }
+
+    /* A truncated prefix would select other commands */
+    if (iLINE_TOO_LONG == iLen)
+    {
+      app_printf(stderr, "%s line %u: too long\n", acTIMEOUT_FILE, uiLine);
+      continue;
+    }
+
+    pcLine = g_tState.acCmd;
+
+    while ((' ' == *pcLine) || ('\t' == *pcLine))
+    {
+      ++pcLine;
+    }
+
+    /* Skip empty lines and comments */
+    if (('\0' == *pcLine) || ('#' == *pcLine) || (';' == *pcLine))
+    {
+      continue;
+    }
+
+    /* "prefix ms" */
+    pcValue = pcLine;
+    while (('\0' != *pcValue) && (' ' != *pcValue) && ('\t' != *pcValue))
+    {
+      ++pcValue;
+    }
+
+    pEntry = &pState->atUser[pState->uiUser];
+
+    if (('\0' != *pcValue) && (sizeof(pEntry->acPrefix) > (uint8_t) (pcValue - pcLine)))
+    {
+      *pcValue++ = '\0';
+
+      if (0 != (pEntry->uiTimeout = (uint16_t) strtoul(pcValue, 0, 0)))
+      {
+        strcpy(pEntry->acPrefix, pcLine);
+        ++pState->uiUser;
+      }
+    }
+  }
+
+EXIT_TIMEOUTS:
+  esx_f_close(g_tState.batch.hFile);
+  g_tState.batch.hFile = 0xFF;
+
+  DBGPRINTF("loadTimeouts() - %u\n", pState->uiUser);
+
+  return EOK;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* commandTimeout()                                                           */
+/*----------------------------------------------------------------------------*/
+uint16_t commandTimeout(const char_t* acCmd, uint8_t* puiEntry)
+{
+  uint16_t uiTimeout = g_tState.uiTimeout;
+  uint16_t uiLearned;
+  uint8_t i;
+
+  *puiEntry = 0xFF;
+
+  if (g_tState.timeout.bFixed)
+  {
+    return uiTimeout;
+  }
+
+  /* The timeout file is authoritative: no learning */
+  for (i = 0; i < g_tState.link.tState.uiUser; ++i)
+  {
+    const usertimeout_t* pEntry = &g_tState.link.tState.atUser[i];
+
+    if (0 == strnicmp(acCmd, pEntry->acPrefix, strlen(pEntry->acPrefix)))
+    {
+      return pEntry->uiTimeout;
+    }
+  }
+
+  for (i = 0; i < uiTIMEOUT_ENTRIES; ++i)
+  {
+    if (0 == strnicmp(acCmd, g_atTimeouts[i].acPrefix, strlen(g_atTimeouts[i].acPrefix)))
+    {
+      uiTimeout = g_atTimeouts[i].uiTimeout;
+      break;
+    }
+  }
+
+  /* i = uiTIMEOUT_ENTRIES: all other commands */
+  *puiEntry = i;
+
+  /* Twice the longest gap observed so far, if this exceeds the budget */
+  uiLearned = g_tState.link.tState.auiLearned[i];
+
+  if (uiLearned > (uiTimeout / 2))
+  {
+    uiTimeout = (0x8000 > uiLearned) ? uiLearned * 2 : 0xFFFF;
+  }
+
+  ESPTRACE(ESPTRACE_BUDGET, uiTimeout);
+
+  return uiTimeout;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* learnTimeout()                                                             */
+/*----------------------------------------------------------------------------*/
+void learnTimeout(uint8_t uiEntry)
+{
+  uint16_t uiOld;
+  uint16_t uiNew;
+
+  if (uiTIMEOUT_ENTRIES >= uiEntry)
+  {
+    uiOld = g_tState.link.tState.auiLearned[uiEntry];
+
+    /* Longer gaps are taken at once, shorter gaps decay towards the gap by
+       a quarter of the difference (at least 1 ms: the gap itself is reached) */
+    uiNew = (g_tState.rx.uiGap >= uiOld) ?
+            g_tState.rx.uiGap : uiOld - ((uiOld - g_tState.rx.uiGap) / 4) - 1;
+
+    if (uiNew != uiOld)
+    {
+      g_tState.link.tState.auiLearned[uiEntry] = uiNew;
+      g_tState.link.bDirty = true;
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* loadLinkState()                                                            */
+/*----------------------------------------------------------------------------*/
+int loadLinkState(void)
+{
+  int iReturn = EINVAL;
+  uint8_t hFile;
+
+  if (0xFF != (hFile = esx_f_open(acLINK_STATE_FILE, ESX_MODE_READ | ESX_MODE_OPEN_EXIST)))
+  {
+    if (sizeof(g_tState.link.tState) == esx_f_read(hFile, &g_tState.link.tState, sizeof(g_tState.link.tState)))
+    {
+      /* "-b auto": the rate of the last session is the first candidate,
+         even if the link state itself is outdated */
+      if (g_tState.bAutoBaud && g_tState.link.tState.uiBaudrate)
+      {
+        g_tState.uiBaudrate = g_tState.link.tState.uiBaudrate;
+      }
+
+      iReturn = EOK;
+    }
+    else
+    {
+      /* Record of another version: nothing of it is used */
+      memset(&g_tState.link.tState, 0, sizeof(g_tState.link.tState));
+    }
+
+    esx_f_close(hFile);
+  }
+
+  DBGPRINTF("loadLinkState() - %d\n", iReturn);
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* isLinkValid()                                                              */
+/*----------------------------------------------------------------------------*/
+bool isLinkValid(void)
+{
+  uint16_t uiNow = espuart_seconds();
+
+  /* "FRAMES" restarts at 0 after a reset, the file survives: a time of the
+     sync in the future is invalid, not a wrap-around */
+  return (uiLINK_STATE_MAGIC == g_tState.link.tState.uiMagic) &&
+         (g_tState.uiBaudrate == g_tState.link.tState.uiBaudrate) &&
+         (uiNow >= g_tState.link.tState.uiSync) &&
+         (uiLINK_STATE_VALID >= (uiNow - g_tState.link.tState.uiSync));
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* saveLinkState()                                                            */
+/*----------------------------------------------------------------------------*/
+int saveLinkState(void)
+{
+  int iReturn = EBADF;
+  uint8_t hFile;
+
+  if (0xFF != (hFile = esx_f_open(acLINK_STATE_FILE, ESX_MODE_WRITE | ESX_MODE_OPEN_CREAT_TRUNC)))
+  {
+    if (sizeof(g_tState.link.tState) == esx_f_write(hFile, &g_tState.link.tState, sizeof(g_tState.link.tState)))
+    {
+      iReturn = EOK;
+    }
+
+    esx_f_close(hFile);
+  }
+
+  g_tState.link.bDirty = false;
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* queryFirmware()                                                            */
+/*----------------------------------------------------------------------------*/
+int queryFirmware(void)
+{
+  static const char_t acPrefix[] = "< AT version:";
+  int iReturn;
+
+  /* The version is captured directly into the link state */
+  g_tState.rx.pcCapture     = g_tState.link.tState.acFirmware;
+  g_tState.rx.acCapture     = acPrefix;
+  g_tState.rx.uiCaptureSize = sizeof(g_tState.link.tState.acFirmware);
+  g_tState.rx.uiCapture     = 0;
+
+  if ((EOK != (iReturn = request("AT+GMR", g_tState.uiTimeout))) || g_tState.rx.pcCapture)
+  {
+    g_tState.link.tState.acFirmware[0] = '\0';
+  }
+
+  g_tState.rx.pcCapture = 0;
+
+  DBGPRINTF("queryFirmware() - %s\n", g_tState.link.tState.acFirmware);
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* execute()                                                                  */
+/*----------------------------------------------------------------------------*/
+int execute(const char_t* acCmd)
+{
+  int iReturn;
+  int iResult;
+  uint8_t uiEntry;
+  uint16_t uiTimeout = commandTimeout(acCmd, &uiEntry);
+  uint16_t uiBackoff = uiRETRY_BACKOFF;
+  bool bReadOnly = isReadOnly(acCmd);
+
+  g_tState.retry.uiUsed = 0;
+
+  /* The command is on the screen already in the interactive mode */
+  if (ACTION_INTERACTIVE != g_tState.eAction)
+  {
+    app_printf(stdout, "> %s\n", acCmd);
+  }
+
+  for ( ; ; )
+  {
+    g_tState.rx.bSilent = false;
+    iReturn = transact(acCmd, uiTimeout);
+
+    /* Cached link state was wrong: full initialization and retry once */
+    if ((ETIMEOUT == iReturn) && !g_tState.rx.bBusy && g_tState.link.bCached)
+    {
+      uint32_t uiStart = espuart_micros();
+
+      iReturn = initSession();
+      g_tState.timing.uiSetup += espuart_micros() - uiStart;
+
+      if ((EOK == iReturn) && bReadOnly)
+      {
+        g_tState.rx.bSilent = false;
+        iReturn = transact(acCmd, uiTimeout);
+      }
+      else if (EOK == iReturn)
+      {
+        iReturn = ETIMEOUT;
+      }
+    }
+    else if ((ETIMEOUT == iReturn) && !g_tState.rx.bBusy && !bReadOnly)
+    {
+      /* The command may have been executed: drop its late response only */
+      syncLink(uiSYNC_PROBES);
+    }
+
+    /* ESP8266 busy or transient timeout of a query: back off, resync and
+       send again */
+    if ((ETIMEOUT != iReturn) || !(g_tState.rx.bBusy || bReadOnly) ||
+        (EOK != resync(&uiBackoff)))
+    {
+      break;
+    }
+  }
+
+  if (g_tState.retry.uiUsed)
+  {
+    app_printf(stderr, "retries: %u\n", g_tState.retry.uiUsed);
+  }
+
+  /* Only complete responses are a valid observation */
+  if ((EOK == iReturn) || (ESTAT == iReturn) || (ERANGE == iReturn))
+  {
+    learnTimeout(uiEntry);
+  }
+
+  /* Records of the command ("-e"); errors of the command take precedence */
+  if (espkv_active())
+  {
+    espkv_line();
+    iResult = exportWrite();
+    iReturn = (EOK != iReturn) ? iReturn : iResult;
+  }
+
+  if (g_tState.timing.bEnabled)
+  {
+    recordTiming(acCmd, iReturn);
+  }
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* isReadOnly()                                                               */
+/*----------------------------------------------------------------------------*/
+bool isReadOnly(const char_t* acCmd)
+{
+  uint16_t uiLen = (uint16_t) strcspn(acCmd, "=");
+  uint8_t i;
+
+  /* Queries and tests */
+  if ((0 != acCmd[0]) && ('?' == acCmd[strlen(acCmd) - 1]))
+  {
+    return true;
+  }
+
+  for (i = 0; i < (sizeof(g_acReadOnly) / sizeof(g_acReadOnly[0])); ++i)
+  {
+    if ((uiLen == strlen(g_acReadOnly[i])) && (0 == strnicmp(acCmd, g_acReadOnly[i], uiLen)))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* resync()                                                                   */
+/*----------------------------------------------------------------------------*/
+int resync(uint16_t* puiBackoff)
+{
+  while (g_tState.retry.uiUsed < g_tState.retry.uiMax)
+  {
+    ++g_tState.retry.uiUsed;
+
+    /* Late responses of the rejected command are dropped */
+    discard(*puiBackoff);
+
+    if (uiRETRY_BACKOFF_MAX > *puiBackoff)
+    {
+      *puiBackoff <<= 1;
+    }
+
+    if (EOK == request("AT", uiRETRY_PROBE))
+    {
+      return EOK;
+    }
+  }
+
+  return ETIMEOUT;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* request()                                                                  */
+/*----------------------------------------------------------------------------*/
+int request(const char_t* acCmd, uint16_t uiTimeout)
+{
+  int iReturn;
+
+  g_tState.rx.bSilent = true;
+  iReturn = transact(acCmd, uiTimeout);
+  g_tState.rx.bSilent = false;
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* transact()                                                                 */
+/*----------------------------------------------------------------------------*/
+int transact(const char_t* acCmd, uint16_t uiTimeout)
+{
+  bool bRender;
+
+  awaitOutstanding(uiTimeout);
+
+  /* The line limit ("-n") applies to each command of the user */
+  if (!g_tState.rx.bSilent)
+  {
+    g_tState.filter.uiLines = 0;
+  }
+
+  if (g_tState.timing.bEnabled)
+  {
+    g_tState.timing.uiFirst = 0;
+    g_tState.timing.uiFinal = 0;
+    g_tState.timing.uiPrint = 0;
+    g_tState.timing.uiLines = 0;
+    g_tState.timing.uiBytes = 0;
+    espuart_stats(&g_tState.timing.tUart);
+    g_tState.timing.uiTx    = espuart_micros();
+  }
+
+  /* Send request to ESP8266: the command in place, then the line end; a
+     replay ("-P") takes the responses from the transcript */
+  if ((ACTION_REPLAY != g_tState.eAction) &&
+      ((EOK != esp_transmit(&g_tState.tEsp, acCmd)) ||
+       (EOK != esp_transmit(&g_tState.tEsp, "\r\n"))))
+  {
+    return ENOTSUP;
+  }
+
+  ESPTRACE(ESPTRACE_TX, strlen(acCmd));
+
+  if (EOK != rawCopy(uiTRANSCRIPT_CMD, acCmd, strlen(acCmd)))
+  {
+    return EBADF;
+  }
+
+  /* Nothing to show or to match: the lines are only classified ("-q") */
+  bRender = g_tState.rx.bSilent ? (0 != g_tState.rx.pcCapture) : (!g_tState.bQuiet || espmatch_count() || espkv_active());
+
+  /* Commands of the user are captured first with "-M" */
+  if ((g_tState.rx.bBanked = (bRender && !g_tState.rx.bSilent && espbank_pages())))
+  {
+    espbank_reset();
+    esptok_reset(0);
+  }
+  else
+  {
+    esptok_reset(bRender ? content : 0);
+  }
+
+  return awaitResponse(uiTimeout);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* awaitOutstanding()                                                         */
+/*----------------------------------------------------------------------------*/
+void awaitOutstanding(uint16_t uiTimeout)
+{
+  bool bSilent = g_tState.rx.bSilent;
+
+  /* Final response of a command that ended early on a pattern */
+  if (g_tState.rx.bOutstanding)
+  {
+    g_tState.rx.bOutstanding = false;
+    g_tState.rx.bSilent = true;
+    awaitResponse(uiTimeout);
+    g_tState.rx.bSilent = bSilent;
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* awaitResponse()                                                            */
+/*----------------------------------------------------------------------------*/
+int awaitResponse(uint16_t uiTimeout)
+{
+  int iReturn;
+  const char_t* pcData;
+  uint16_t uiCount;
+  uint16_t uiUsed;
+  uint16_t uiLast;
+  esptoken_t eToken;
+
+  g_tState.rx.uiMatch = 0;
+  g_tState.rx.uiGap   = 0;
+  g_tState.rx.bBusy   = false;
+
+  /* Receive response: the data is processed in place in the ring buffer */
+  uiLast = espuart_clock();
+
+  for ( ; ; )
+  {
+    if (0 == (uiCount = espio_span(&pcData)))
+    {
+      /* ESP8266 idle: write a full block of the raw copy ("-o") */
+      if (g_tState.pcRawFile && g_tState.xfer.bPending)
+      {
+        g_tState.xfer.bPending = false;
+        ESPTRACE(ESPTRACE_BLOCK, g_tState.xfer.uiBlock ^ 1);
+
+        if (EOK != (iReturn = writeBlock(g_tState.xfer.uiBlock ^ 1, uiXFER_BLOCK)))
+        {
+          break;
+        }
+
+        uiLast = espuart_clock();
+        continue;
+      }
+
+      /* ESP8266 idle: render queued output to the console */
+      if (outq_count())
+      {
+        ESPTRACE(ESPTRACE_RENDER, outq_count());
+        render(false);
+        uiLast = espuart_clock();
+        continue;
+      }
+
+      /* Replay: no more recorded data, the response timed out as well */
+      if (((uint16_t) (espuart_clock() - uiLast) > uiTimeout) || g_tState.transcript.bEnd)
+      {
+        ESPTRACE(ESPTRACE_TIMEOUT, uiTimeout);
+
+        /* The link is in an unknown state: invalidate the cached state */
+        g_tState.link.tState.uiMagic = 0;
+        g_tState.link.bDirty = true;
+        iReturn = ETIMEOUT;
+        break;
+      }
+
+      continue;
+    }
+
+    if ((uint16_t) (espuart_clock() - uiLast) > g_tState.rx.uiGap)
+    {
+      g_tState.rx.uiGap = espuart_clock() - uiLast;
+    }
+
+    uiLast = espuart_clock();
+    uiUsed = esptok_scan(pcData, uiCount, &eToken);
+
+    if (ESPTOK_NONE != eToken)
+    {
+      ESPTRACE(ESPTRACE_LINE, eToken);
+    }
+
+    if (g_tState.rx.bBanked)
+    {
+      espbank_write(pcData, uiUsed);
+    }
+
+    /* Raw copy of the responses to the commands of the user ("-o", "-R") */
+    if (EOK != (iReturn = rawCopy(uiTRANSCRIPT_RX, pcData, uiUsed)))
+    {
+      espio_consume(uiUsed);
+      break;
+    }
+
+    espio_consume(uiUsed);
+
+    if (g_tState.timing.bEnabled)
+    {
+      if (0 == g_tState.timing.uiBytes)
+      {
+        g_tState.timing.uiFirst = espuart_micros() - g_tState.timing.uiTx;
+      }
+
+      g_tState.timing.uiBytes += uiUsed;
+      g_tState.timing.uiLines += (ESPTOK_NONE != eToken) ? 1 : 0;
+    }
+
+    if (esptok_final(eToken))
+    {
+      syncLinkState();
+
+      if ((ESPTOK_OK == eToken) || (ESPTOK_SEND_OK == eToken) || (ESPTOK_PROMPT == eToken))
+      {
+        iReturn = EOK;
+      }
+      else
+      {
+        iReturn = (ESPTOK_ERROR == eToken) ? ESTAT : ERANGE;
+      }
+      break;
+    }
+
+    if (ESPTOK_NONE != eToken)
+    {
+      if (!g_tState.rx.bBanked)
+      {
+        output("\n", 1); /* End of a printable line */
+        filterLine();
+      }
+
+      /* The ESP8266 rejected the command: no final response will follow */
+      if (ESPTOK_BUSY == eToken)
+      {
+        g_tState.rx.bBusy = true;
+        iReturn = ETIMEOUT;
+        break;
+      }
+
+      /* Line with a pattern ("-w", "-x"): no need to wait for the final response */
+      if (g_tState.rx.uiMatch)
+      {
+        g_tState.rx.bOutstanding = true;
+        iReturn = (uiEXPECT_SUCCESS == g_tState.rx.uiMatch) ? EOK : ESTAT;
+        break;
+      }
+    }
+  }
+
+  if (g_tState.timing.bEnabled)
+  {
+    g_tState.timing.uiFinal = espuart_micros() - g_tState.timing.uiTx;
+  }
+
+  if (g_tState.rx.bBanked)
+  {
+    g_tState.rx.bBanked = false;
+    iReturn = replayResponse(iReturn);
+  }
+
+  /* Final response: render the rest of the output */
+  render(true);
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* replayResponse()                                                           */
+/*----------------------------------------------------------------------------*/
+int replayResponse(int iResult)
+{
+  const char_t* pcData;
+  uint32_t uiPos = 0;
+  uint16_t uiCount;
+  esptoken_t eToken;
+
+  if (espbank_lost())
+  {
+    app_printf(stderr, "mem: %lu bytes lost\n", (unsigned long) espbank_lost());
+  }
+
+  esptok_reset(content);
+
+  while (0 != (uiCount = espbank_map(uiPos, &pcData)))
+  {
+    uiPos += esptok_scan(pcData, uiCount, &eToken);
+    espbank_unmap();
 
-    zxn_setspeed(RTM_28MHZ);
-    esp_open(&g_tState.tEsp);
+    if ((ESPTOK_NONE != eToken) && !esptok_final(eToken))
+    {
+      output("\n", 1); /* End of a printable line */
+      filterLine();
 
-    g_tState.bInitialized = true;
+      /* Line with a pattern ("-w", "-x"): the rest is not shown */
+      if (g_tState.rx.uiMatch)
+      {
+        return (uiEXPECT_SUCCESS == g_tState.rx.uiMatch) ? EOK : ESTAT;
+      }
+    }
   }
+
+  return iResult;
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* _destruct()                                                                */
+/* render()                                                                   */
 /*----------------------------------------------------------------------------*/
-void _destruct(void)
+void render(bool bAll)
 {
-  if (g_tState.bInitialized)
+  uint32_t uiStart = g_tState.timing.bEnabled ? espuart_micros() : 0;
+
+  if (bAll)
   {
-    esp_close(&g_tState.tEsp);
-    zxn_setspeed(g_tState.uiSpeed);
+    /* Incomplete line (timeout, message without line end) */
+    filterLine();
+    outq_flush();
+  }
+  else
+  {
+    outq_drain(uiOUTQ_QUANTUM);
+  }
+
+  if (g_tState.timing.bEnabled)
+  {
+    g_tState.timing.uiPrint += espuart_micros() - uiStart;
   }
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* main()                                                                     */
+/* recordTiming()                                                             */
 /*----------------------------------------------------------------------------*/
-int main(int argc, char* argv[])
+void recordTiming(const char_t* acCmd, int iResult)
 {
-  _construct();
-  atexit(_destruct);
+  static const char_t acHeader[] = acTIMING_HEADER;
+  struct esx_stat tStat;
+  uint32_t uiTime = g_tState.timing.uiFinal - g_tState.timing.uiFirst;
+  uint32_t uiRate = (1000 <= uiTime) ? transferRate(g_tState.timing.uiBytes, uiTime / 1000) : 0;
+  uint8_t hFile;
 
-  if (EOK == (g_tState.iExitCode = parseArguments(argc, argv)))
+  espuart_stats(&g_tState.timing.tUart);
+
+  if (g_tState.timing.bPrint)
   {
-    switch (g_tState.eAction)
+    app_printf(stdout, "T s=%lu f=%lu e=%lu p=%lu n=%u b=%lu r=%lu h=%u o=%u\n",
+               (unsigned long) g_tState.timing.uiSetup,
+               (unsigned long) g_tState.timing.uiFirst,
+               (unsigned long) g_tState.timing.uiFinal,
+               (unsigned long) g_tState.timing.uiPrint,
+               g_tState.timing.uiLines,
+               (unsigned long) g_tState.timing.uiBytes,
+               (unsigned long) uiRate,
+               g_tState.timing.tUart.uiThrottled,
+               g_tState.timing.tUart.uiOverruns);
+  }
+
+  if (g_tState.timing.pcLog &&
+      (0xFF != (hFile = esx_f_open(g_tState.timing.pcLog, ESX_MODE_WRITE | ESX_MODE_OPEN_CREAT))))
+  {
+    if ((0 == esx_f_fstat(hFile, &tStat)) && (0 == tStat.size))
     {
-      case ACTION_NONE:
-        g_tState.iExitCode = EOK;
-        break;
+      esx_f_write(hFile, acHeader, sizeof(acHeader) - 1);
+    }
+    else
+    {
+      esx_f_seek(hFile, 0, ESX_SEEK_END);
+    }
 
-      case ACTION_HELP:
-        g_tState.iExitCode = showHelp();
-        break;
+    /* Name of the command only: parameters may contain passwords */
+    esx_f_write(hFile, acCmd, strcspn(acCmd, "="));
 
-      case ACTION_INFO:
-        g_tState.iExitCode = showInfo();
-        break;
+    espfmt_print(fileSink, &hFile,
+                 ",%d,%u,%lu,%lu,%lu,%lu,%u,%lu,%lu,%u,%lu,%u,%u,\"%s\"\n",
+                 iResult, espuart_seconds(),
+                 (unsigned long) g_tState.timing.uiSetup,
+                 (unsigned long) g_tState.timing.uiFirst,
+                 (unsigned long) g_tState.timing.uiFinal,
+                 (unsigned long) g_tState.timing.uiPrint,
+                 g_tState.timing.uiLines,
+                 (unsigned long) g_tState.timing.uiBytes,
+                 (unsigned long) uiRate,
+                 g_tState.retry.uiUsed,
+                 (unsigned long) (g_tState.uiTurboBaudrate ? g_tState.uiTurboBaudrate : g_tState.uiBaudrate),
+                 g_tState.timing.tUart.uiThrottled,
+                 g_tState.timing.tUart.uiOverruns,
+                 g_tState.link.tState.acFirmware);
 
-      case ACTION_COMMAND:
-        g_tState.iExitCode = command();
-        break;
-    }
+    esx_f_close(hFile);
   }
 
-  return (int) (EOK == g_tState.iExitCode ? 0 : zxn_strerror(g_tState.iExitCode));
+  /* The setup is counted for the first command of a session only */
+  g_tState.timing.uiSetup = 0;
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* app_printf()                                                               */
+/* output()                                                                   */
 /*----------------------------------------------------------------------------*/
-int app_printf(FILE* pStream, char_t* acFmt, ...)
+void output(const char_t* pcData, uint16_t uiLen)
 {
-  int iReturn = EOK;
-
-  if (pStream && acFmt) 
+  if (!g_tState.rx.bSilent)
   {
     if (!g_tState.bQuiet)
     {
-      va_list args;
-      va_start(args, acFmt);
-
-      iReturn = vfprintf(pStream, acFmt, args);
-
-      va_end(args);
+      outq_put(pcData, uiLen);
     }
   }
-  else
+  else if (g_tState.rx.pcCapture)
   {
-    iReturn = -EINVAL;
+    capture(pcData, uiLen);
   }
-
-  return iReturn;
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* parseArguments()                                                           */
+/* capture()                                                                  */
 /*----------------------------------------------------------------------------*/
-int parseArguments(int argc, char* argv[])
+void capture(const char_t* pcData, uint16_t uiLen)
 {
-  int iReturn = EOK;
-
-  /* Defaults */
-  g_tState.eAction = ACTION_NONE;
+  char_t* pcCapture = g_tState.rx.pcCapture;
+  const char_t* acPrefix = g_tState.rx.acCapture;
+  uint8_t uiPrefix = (uint8_t) strlen(acPrefix);
+  uint8_t uiPos;
+  char_t c;
 
-  int i = 1;
-  while (i < argc)
+  while (uiLen--)
   {
-    const char_t* acArg = argv[i];
+    c = *pcData++;
+    uiPos = g_tState.rx.uiCapture;
 
-    if ('-' == acArg[0]) /* Options */
+    if ('\n' == c)
     {
-      if ((0 == strcmp(acArg, "-h")) || (0 == stricmp(acArg, "--help")))
-      {
-        g_tState.eAction = ACTION_HELP;
-      }
-      else if ((0 == strcmp(acArg, "-v")) || (0 == stricmp(acArg, "--version")))
-      {
-        g_tState.eAction = ACTION_INFO;
-      }
-      else if ((0 == strcmp(acArg, "-q")) || (0 == stricmp(acArg, "--quiet")))
-      {
-        g_tState.bQuiet = true;
-      }
-      else if ((0 == strcmp(acArg, "-b")) || (0 == stricmp(acArg, "--baudrate")))
-      {
-        if ((i + 1) < argc)
-        {
-          g_tState.uiBaudrate = strtoul(argv[++i], 0, 0);
-        }
-        else
-        {
-          app_printf(stderr, "option %s requires a value\n", acArg);
-          iReturn = EINVAL;
-          break;
-        }
-      }
-      else if ((0 == strcmp(acArg, "-t")) || (0 == stricmp(acArg, "--timeout")))
-      {
-        if ((i + 1) < argc)
-        {
-          g_tState.uiTimeout = strtoul(argv[++i], 0, 0);
-        }
-        else
-        {
-          app_printf(stderr, "option %s requires a value\n", acArg);
-          iReturn = EINVAL;
-          break;
-        }
-      }
-      else
+      if ((0xFF != uiPos) && (uiPrefix <= uiPos))
       {
-        app_printf(stderr, "unknown option: %s\n", acArg);
-        iReturn = EINVAL;
-        break;
+        g_tState.rx.pcCapture = 0; /* Done */
+        return;
       }
+
+      g_tState.rx.uiCapture = 0;
     }
-    else /* Arguments */
+    else if (0xFF == uiPos)
     {
-      if ('\0' == g_tState.acCmd[0])
-      {
-        snprintf(g_tState.acCmd, sizeof(g_tState.acCmd), "%s", acArg);
-      }
-      else
-      {
-        app_printf(stderr, "unexpected argument: %s\n", acArg);
-        iReturn = EINVAL;
-        break;
-      }
+      /* Line without the prefix: skipped up to its end */
+    }
+    else if (uiPos < uiPrefix)
+    {
+      /* The prefix is compared, but not stored */
+      g_tState.rx.uiCapture = (c == acPrefix[uiPos]) ? uiPos + 1 : 0xFF;
+      pcCapture[0] = '\0';
+    }
+    else if ((uint8_t) (uiPos - uiPrefix) < (g_tState.rx.uiCaptureSize - 1))
+    {
+      pcCapture[uiPos - uiPrefix]     = c;
+      pcCapture[uiPos - uiPrefix + 1] = '\0';
+      ++g_tState.rx.uiCapture;
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* syncLinkState()                                                            */
+/*----------------------------------------------------------------------------*/
+void syncLinkState(void)
+{
+  uint16_t uiNow = espuart_seconds();
+
+  /* Written back at most every half validity period */
+  if ((uiLINK_STATE_MAGIC != g_tState.link.tState.uiMagic) ||
+      ((uiLINK_STATE_VALID / 2) < (uint16_t) (uiNow - g_tState.link.tState.uiSync)))
+  {
+    g_tState.link.tState.uiMagic = uiLINK_STATE_MAGIC;
+    g_tState.link.tState.uiSync  = uiNow;
+    g_tState.link.bDirty = true;
+  }
+
+  g_tState.link.bSynced = true;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* content()                                                                  */
+/*----------------------------------------------------------------------------*/
+void content(const char_t* pcData, uint16_t uiLen, bool bFirst)
+{
+  if (bFirst)
+  {
+    /* Filtered lines are held in the output queue until they are decided */
+    if (!g_tState.rx.bSilent && !g_tState.bQuiet &&
+        (g_tState.filter.bInclude || g_tState.filter.bExclude || g_tState.filter.uiMax))
+    {
+      outq_hold();
+      g_tState.filter.bHeld = true;
+      g_tState.rx.uiTags    = 0;
     }
 
-    ++i;
+    output("< ", 2);
   }
 
-  if (EOK == iReturn)
+  output(pcData, uiLen);
+
+  /* Patterns apply to the commands of the user only */
+  if (!g_tState.rx.bSilent && espmatch_count())
   {
-    if (ACTION_NONE == g_tState.eAction)
+    if (bFirst)
     {
-      if ('\0' != g_tState.acCmd[0])
-      {
-        g_tState.eAction = ACTION_COMMAND;
-      }
-      else
-      {
-        app_printf(stderr, "no command specified\n");
-        iReturn = EINVAL;
-      }
+      espmatch_line();
     }
+
+    g_tState.rx.uiTags  = espmatch_feed(pcData, uiLen);
+    g_tState.rx.uiMatch = g_tState.rx.uiTags & (uiEXPECT_SUCCESS | uiEXPECT_FAILURE);
   }
 
-  DBGPRINTF("parseargs() - action   = %d\n", g_tState.eAction);
-  DBGPRINTF("parseargs() - command  = %s\n", g_tState.acCmd);
-  DBGPRINTF("parseargs() - baudrate = %lu\n", g_tState.uiBaudrate);
-  DBGPRINTF("parseargs() - timeout  = %u\n", g_tState.uiTimeout);
+  /* Without exclude patterns a shown line is decided by its first include
+     match (or at its start): it streams on and cannot be dropped by a full
+     queue. Rejected lines stay held up to their end. */
+  if (g_tState.filter.bHeld && !g_tState.filter.bExclude &&
+      (!g_tState.filter.bInclude || (g_tState.rx.uiTags & uiFILTER_INCLUDE)) &&
+      (!g_tState.filter.uiMax || (g_tState.filter.uiLines < g_tState.filter.uiMax)))
+  {
+    filterLine();
+  }
 
-  return iReturn;
+  /* Fields of the responses to the commands of the user ("-e") */
+  if (!g_tState.rx.bSilent && espkv_active())
+  {
+    if (bFirst)
+    {
+      espkv_line();
+    }
+
+    espkv_feed(pcData, uiLen);
+  }
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* showHelp()                                                                 */
+/* filterLine()                                                               */
 /*----------------------------------------------------------------------------*/
-int showHelp(void)
+void filterLine(void)
 {
-  char_t acAppName[0x10];
-  strncpy(acAppName, VER_INTERNALNAME_STR, sizeof(acAppName));
-  strupr(acAppName);
+  bool bShow;
 
-  app_printf(stdout, "%s\n\n", VER_FILEDESCRIPTION_STR);
+  if (g_tState.filter.bHeld)
+  {
+    g_tState.filter.bHeld = false;
 
-  app_printf(stdout, "%s cmd [-b x][-t x][-q][-h|-v]\n\n", acAppName);
-  //                  0.........1.........2.........3.
-  app_printf(stdout, " cmd         command to execute\n");
-  app_printf(stdout, " -b[audrate] baudrate in [bit/s]\n");
-  app_printf(stdout, " -t[imeout]  timeout in [ms]\n");
-  app_printf(stdout, " -q[uiet]    no screen output\n");
-  app_printf(stdout, " -h[elp]     print this help\n");
-  app_printf(stdout, " -v[ersion]  print version info\n");
+    bShow = (!g_tState.filter.bInclude || (g_tState.rx.uiTags & uiFILTER_INCLUDE)) &&
+            !(g_tState.rx.uiTags & uiFILTER_EXCLUDE) &&
+            (!g_tState.filter.uiMax || (g_tState.filter.uiLines < g_tState.filter.uiMax));
 
-  return EOK;
+    /* Counted if it is shown: not rejected and not dropped by a full queue */
+    if (outq_release(bShow))
+    {
+      ++g_tState.filter.uiLines;
+    }
+  }
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* showInfo()                                                                 */
+/* enableTurbo()                                                              */
 /*----------------------------------------------------------------------------*/
-int showInfo(void)
+int enableTurbo(void)
 {
-  char_t acBuffer[0x10];
-  uint16_t uiVersion;
+  uint32_t uiGood = g_tState.uiBaudrate;
+  uint32_t uiRate;
+  uint8_t i;
 
-  strncpy(acBuffer, VER_INTERNALNAME_STR, sizeof(acBuffer));
-  strupr(acBuffer);
+  /* Step up the list of rates; stop at the first rate that fails */
+  for (i = 0; i < (sizeof(g_auiTurboBaudrates) / sizeof(g_auiTurboBaudrates[0])); ++i)
+  {
+    if ((uiRate = g_auiTurboBaudrates[i]) <= uiGood)
+    {
+      continue;
+    }
 
-  app_printf(stdout, "%s " VER_LEGALCOPYRIGHT_STR "\n", acBuffer);
+    /* ESP8266 answers with the old rate and switches after "OK" */
+    if (EOK != setEspBaudrate(uiRate))
+    {
+      break;
+    }
 
-  if (ESX_DOSVERSION_NEXTOS_48K != (uiVersion = esx_m_dosversion()))
-  {
-    snprintf(acBuffer, sizeof(acBuffer), "NextOS %u.%02u",
-             ESX_DOSVERSION_NEXTOS_MAJOR(uiVersion),
-             ESX_DOSVERSION_NEXTOS_MINOR(uiVersion));
+    if (EOK == request("AT", uiTURBO_TIMEOUT))
+    {
+      uiGood = uiRate;
+      g_tState.uiTurboBaudrate = uiRate;
+      continue;
+    }
+
+    /* Verification failed: return to the last good rate on both sides */
+    setEspBaudrate(uiGood);
+
+    if (EOK != request("AT", uiTURBO_TIMEOUT))
+    {
+      return ETIMEOUT;
+    }
+
+    break;
   }
-  else
+
+  if (g_tState.uiTurboBaudrate)
   {
-    strncpy(acBuffer, "48K mode", sizeof(acBuffer));
+    app_printf(stdout, "turbo: %lu bit/s\n", (unsigned long) g_tState.uiTurboBaudrate);
   }
 
-  //                  0.........1.........2.........3.
-  app_printf(stdout, " Version %s (%s)\n", VER_FILEVERSION_STR, acBuffer);
-  app_printf(stdout, " Stefan Zell (info@diezells.de)\n");
-
   return EOK;
 }
 
 
 /*----------------------------------------------------------------------------*/
-/* command()                                                                  */
+/* setEspBaudrate()                                                           */
 /*----------------------------------------------------------------------------*/
-int command(void)
+int setEspBaudrate(uint32_t uiBaudrate)
+{
+  /* On the stack: "acCmd" may hold the command that opened the session */
+  char_t acRequest[0x20];
+  int iReturn;
+
+  /* Flow control: 0 = none, 3 = RTS and CTS */
+  espfmt_format(acRequest, sizeof(acRequest),
+                "AT+UART_CUR=%lu,8,1,0,%u", (unsigned long) uiBaudrate,
+                g_tState.bFlowActive ? 3 : 0);
+
+  iReturn = request(acRequest, uiTURBO_TIMEOUT);
+
+  /* The UART follows in any case; the ESP8266 may have switched anyway */
+  esp_set_baudrate(&g_tState.tEsp, uiBaudrate);
+  espuart_flow(g_tState.bFlowActive);
+  espio_reset();
+
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* disableTurbo()                                                             */
+/*----------------------------------------------------------------------------*/
+int disableTurbo(void)
 {
   int iReturn = EOK;
 
-  /* Initialize UART / ESP8266 */
-  if (EOK != esp_set_baudrate(&g_tState.tEsp, g_tState.uiBaudrate))
+  if (g_tState.uiTurboBaudrate)
   {
-    iReturn = ENOTSUP;
-    goto EXIT_COMMAND;
+    iReturn = setEspBaudrate(g_tState.uiBaudrate);
+    g_tState.uiTurboBaudrate = 0;
   }
 
-  if (EOK != esp_set_timeout(&g_tState.tEsp, g_tState.uiTimeout))
-  {
-    iReturn = ENOTSUP;
-    goto EXIT_COMMAND;
-  }
+  return iReturn;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* enableFlow()                                                               */
+/*----------------------------------------------------------------------------*/
+int enableFlow(void)
+{
+  uint32_t uiRate = g_tState.uiTurboBaudrate ? g_tState.uiTurboBaudrate : g_tState.uiBaudrate;
 
-  if (EOK != esp_flush(&g_tState.tEsp))
+  g_tState.bFlowActive = true;
+
+  if ((EOK == setEspBaudrate(uiRate)) && (EOK == request("AT", uiTURBO_TIMEOUT)))
   {
-    iReturn = ENOTSUP;
-    goto EXIT_COMMAND;
+    return EOK;
   }
 
-  /* Create request */
-  snprintf(g_tState.esp.acTxBuffer, sizeof(g_tState.esp.acTxBuffer), "%s\r\n", g_tState.acCmd);
-  app_printf(stdout, "> %s\n", g_tState.acCmd);
+  /* Firmware without flow control or lines not connected */
+  app_printf(stderr, "flow: not available\n");
 
-  /* Send request to ESP8266 */
-  if (EOK == esp_transmit(&g_tState.tEsp, g_tState.esp.acTxBuffer))
-  {
-    for ( ; ; )
-    {
-      switch (esp_receive_ex(&g_tState.tEsp, g_tState.esp.acRxBuffer, sizeof(g_tState.esp.acRxBuffer)))
-      {
-        case ESP_LINE_DATA:
-          zxn_rtrim(g_tState.esp.acRxBuffer);
-          if (strlen(g_tState.esp.acRxBuffer))
-          {
-            app_printf(stdout, "< %s\n", g_tState.esp.acRxBuffer);
-          }
-          break;
+  g_tState.bFlowActive = false;
+  setEspBaudrate(uiRate);
 
-        case ESP_LINE_OK:
-          iReturn = EOK;
-          goto EXIT_COMMAND;
+  return request("AT", uiTURBO_TIMEOUT);
+}
 
-        case ESP_LINE_ERROR:
-          iReturn = ESTAT;
-          goto EXIT_COMMAND;
 
-        case ESP_LINE_FAIL:
-          iReturn = ERANGE;
-          goto EXIT_COMMAND;
+/*----------------------------------------------------------------------------*/
+/* disableFlow()                                                              */
+/*----------------------------------------------------------------------------*/
+int disableFlow(void)
+{
+  int iReturn = EOK;
 
-        default:
-          iReturn = ETIMEOUT;
-          goto EXIT_COMMAND;
-      }
-    }
-  }
-  else
+  if (g_tState.bFlowActive)
   {
-    iReturn = ENOTSUP;
+    g_tState.bFlowActive = false;
+    iReturn = setEspBaudrate(g_tState.uiTurboBaudrate ? g_tState.uiTurboBaudrate : g_tState.uiBaudrate);
   }
 
-EXIT_COMMAND:
-
   return iReturn;
 }
 
@@ -0,0 +1,205 @@
+/*-----------------------------------------------------------------------------+
+|                                                                              |
+| filename: outq.c                                                             |
+| project:  ZX Spectrum Next - ESPCMD                                          |
+| author:   Stefan Zell                                                        |
+| date:     10/16/2026                                                         |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| description:                                                                 |
+|                                                                              |
+| Output queue: received data is queued and rendered to the console while the  |
+| ESP8266 is idle, so that the reception always has priority                   |
+|                                                                              |
++------------------------------------------------------------------------------+
+|                                                                              |
+| Copyright (c) 10/16/2026 STZ Engineering                                     |
+|                                                                              |
+| This software is provided  "as is",  without warranty of any kind, express   |
+| or implied. In no event shall STZ or its contributors be held liable for any |
+| direct, indirect, incidental, special or consequential damages arising out   |
+| of the use of or inability to use this software.                             |
+|                                                                              |
+| Permission is granted to anyone  to use this  software for any purpose,      |
+| including commercial applications,  and to alter it and redistribute it      |
+| freely, subject to the following restrictions:                               |
+|                                                                              |
+| 1. Redistributions of source code must retain the above copyright            |
+|    notice, definition, disclaimer, and this list of conditions.              |
+|                                                                              |
+| 2. Redistributions in binary form must reproduce the above copyright         |
+|    notice, definition, disclaimer, and this list of conditions in            |
+|    documentation and/or other materials provided with the distribution.      |
+|                                                                          ;-) |
++-----------------------------------------------------------------------------*/
+
+/*============================================================================*/
+/*                               Includes                                     */
+/*============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "libzxn.h"
+#include "outq.h"
+
+/*============================================================================*/
+/*                               Defines                                      */
+/*============================================================================*/
+/*!
+Mask to wrap indices of the queue
+*/
+#define uiOUTQ_MASK (uiOUTQ_SIZE - 1)
+
+/*============================================================================*/
+/*                               Variablen                                    */
+/*============================================================================*/
+/*!
+Output queue (ring); head, tail and the start of a held line are free running
+indices; "bDropped" is set when the held line did not fit into the queue
+*/
+static struct
+{
+  uint16_t uiHead;
+  uint16_t uiTail;
+  uint16_t uiHold;
+  bool     bHold;
+  bool     bDropped;
+  char_t   acData[uiOUTQ_SIZE];
+} g_tOutQ;
+
+/*============================================================================*/
+/*                               Implementierung                              */
+/*============================================================================*/
+
+/*----------------------------------------------------------------------------*/
+/* outq_put()                                                                 */
+/*----------------------------------------------------------------------------*/
+void outq_put(const char_t* pcData, uint16_t uiLen)
+{
+  uint16_t uiFree;
+
+  /* The rest of a dropped line is discarded up to its release */
+  if (g_tOutQ.bHold && g_tOutQ.bDropped)
+  {
+    return;
+  }
+
+  while (uiLen)
+  {
+    if (0 == (uiFree = uiOUTQ_SIZE - (g_tOutQ.uiHead - g_tOutQ.uiTail)))
+    {
+      /* Queue full of a held line: it is dropped, the filter decides on
+         complete lines only */
+      if (g_tOutQ.bHold && (g_tOutQ.uiHold == g_tOutQ.uiTail))
+      {
+        g_tOutQ.uiHead   = g_tOutQ.uiHold;
+        g_tOutQ.bDropped = true;
+        return;
+      }
+
+      /* Queue full: render the oldest data (blocks the reception) */
+      outq_drain(uiOUTQ_SIZE / 4);
+      continue;
+    }
+
+    if (uiFree > uiLen)
+    {
+      uiFree = uiLen;
+    }
+
+    uiLen -= uiFree;
+
+    while (uiFree--)
+    {
+      g_tOutQ.acData[g_tOutQ.uiHead++ & uiOUTQ_MASK] = *pcData++;
+    }
+  }
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* outq_drain()                                                               */
+/*----------------------------------------------------------------------------*/
+uint16_t outq_drain(uint16_t uiMax)
+{
+  uint16_t uiCount;
+  uint16_t uiIndex;
+
+  while (uiMax && (0 != (uiCount = outq_count())))
+  {
+    /* Contiguous block up to the end of the ring */
+    uiIndex = g_tOutQ.uiTail & uiOUTQ_MASK;
+
+    if (uiCount > (uiOUTQ_SIZE - uiIndex))
+    {
+      uiCount = uiOUTQ_SIZE - uiIndex;
+    }
+
+    if (uiCount > uiMax)
+    {
+      uiCount = uiMax;
+    }
+
+    /* Direct block write; no formatting */
+    fwrite(&g_tOutQ.acData[uiIndex], 1, uiCount, stdout);
+
+    g_tOutQ.uiTail += uiCount;
+    uiMax -= uiCount;
+  }
+
+  return outq_count();
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* outq_count()                                                               */
+/*----------------------------------------------------------------------------*/
+uint16_t outq_count(void)
+{
+  return (g_tOutQ.bHold ? g_tOutQ.uiHold : g_tOutQ.uiHead) - g_tOutQ.uiTail;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* outq_hold()                                                                */
+/*----------------------------------------------------------------------------*/
+void outq_hold(void)
+{
+  g_tOutQ.uiHold   = g_tOutQ.uiHead;
+  g_tOutQ.bHold    = true;
+  g_tOutQ.bDropped = false;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* outq_release()                                                             */
+/*----------------------------------------------------------------------------*/
+bool outq_release(bool bKeep)
+{
+  bKeep = bKeep && g_tOutQ.bHold && !g_tOutQ.bDropped;
+
+  if (!bKeep)
+  {
+    g_tOutQ.uiHead = g_tOutQ.bHold ? g_tOutQ.uiHold : g_tOutQ.uiHead;
+  }
+
+  g_tOutQ.bHold = false;
+
+  return bKeep;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/* outq_flush()                                                               */
+/*----------------------------------------------------------------------------*/
+void outq_flush(void)
+{
+  outq_drain(uiOUTQ_SIZE);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*----------------------------------------------------------------------------*/